@@ -0,0 +1,99 @@
+#include <Game/SweepAndPrune.hpp>
+#include <Game/Foreach.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+
+// Moves a crowd of boxes a little every frame and times the broadphase
+// update, whose pairs are kept in flat sorted vectors, against collecting
+// the same pairs into a std::set as the scene graph collision check used to.
+// Crowds are sized for about 100 to 100,000 overlapping pairs.
+//
+// Usage: CollisionPairBenchmark [frames]
+
+namespace
+{
+	// Height of the strip the boxes are spread over, wide and flat like a corridor
+	const float StripHeight = 128.f;
+	const float BoxSize = 16.f;
+
+	class Box : public SceneNode
+	{
+		public:
+			sf::FloatRect bounds;
+
+			virtual sf::FloatRect getBoundingRect() const
+			{
+				return bounds;
+			}
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100u;
+
+	const std::vector<std::size_t> counts = { 100u, 1000u, 10000u, 100000u };
+
+	std::cout << std::setw(8) << "boxes" << std::setw(9) << "pairs" << std::setw(9) << "frames"
+			  << std::setw(12) << "sweep us" << std::setw(12) << "set us" << std::setw(8) << "equal" << std::endl;
+
+	FOREACH(std::size_t count, counts)
+	{
+		// About one overlapping pair per box
+		const float stripWidth = count * 2.f * BoxSize * BoxSize / StripHeight;
+
+		// Same crowd and moves for every run
+		std::default_random_engine random(static_cast<unsigned int>(count));
+		std::uniform_real_distribution<float> x(0.f, stripWidth), y(0.f, StripHeight), step(-1.f, 1.f);
+
+		SweepAndPrune broadphase;
+		std::vector<std::unique_ptr<Box>> boxes;
+		for (auto i = 0u; i < count; ++i)
+		{
+			std::unique_ptr<Box> box(new Box());
+			box->bounds = sf::FloatRect(x(random), y(random), BoxSize, BoxSize);
+			broadphase.insert(*box);
+			boxes.push_back(std::move(box));
+		}
+		broadphase.update();
+
+		std::set<SceneNode::Pair> set;
+		sf::Time sweepTime, setTime;
+		bool equal = true;
+		sf::Clock clock;
+		for (auto frame = 0u; frame < frames; ++frame)
+		{
+			FOREACH(std::unique_ptr<Box>& box, boxes)
+			{
+				box->bounds.left += step(random);
+				box->bounds.top += step(random);
+			}
+
+			clock.restart();
+			broadphase.update();
+			sweepTime += clock.restart();
+
+			set.clear();
+			FOREACH(const SceneNode::Pair& pair, broadphase.getPairs())
+				set.insert(pair);
+			setTime += clock.restart();
+
+			equal = equal && set.size() == broadphase.getPairs().size();
+		}
+
+		std::cout << std::setw(8) << count << std::setw(9) << broadphase.getPairs().size() << std::setw(9) << frames
+				  << std::setw(12) << std::fixed << std::setprecision(2) << sweepTime.asMicroseconds() / static_cast<float>(frames)
+				  << std::setw(12) << setTime.asMicroseconds() / static_cast<float>(frames)
+				  << std::setw(8) << (equal ? "yes" : "no") << std::endl;
+	}
+}
@@ -0,0 +1,128 @@
+#include <Game/DungeonGenerator.hpp>
+#include <Game/LevelFile.hpp>
+#include <Game/ThreadPool.hpp>
+#include <Game/Foreach.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+
+// Generates dungeons of increasing size from fixed seeds and reports
+// throughput, time per generation stage, the time to load the same map
+// back from a level file and peak memory.
+//
+// Usage: GenerationBenchmark [iterations] [threads] [rooms|caves|partitions]
+
+namespace
+{
+	// Peak resident memory of the process, in MiB
+	double getPeakMemory()
+	{
+	#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+	#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		#ifdef __APPLE__
+			return usage.ru_maxrss / (1024.0 * 1024.0);
+		#else
+			return usage.ru_maxrss / 1024.0;
+		#endif
+	#endif
+	}
+
+	// FNV-1a over the tile types, changes whenever the generated output does
+	unsigned int getChecksum(const Tile::Type* tiles, std::size_t count)
+	{
+		unsigned int hash = 2166136261u;
+		for (auto i = 0u; i < count; ++i)
+			hash = (hash ^ static_cast<unsigned int>(tiles[i])) * 16777619u;
+		return hash;
+	}
+
+	unsigned int getChecksum(const Level& level)
+	{
+		return getChecksum(level.tiles.data(), level.tiles.size());
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 64u;
+	ThreadPool threads(argc > 2 ? std::max(1, std::atoi(argv[2])) : std::thread::hardware_concurrency());
+	DungeonGenerator generator(threads);
+	const std::string layoutName = argc > 3 ? argv[3] : "rooms";
+	const DungeonGenerator::Layout layout = layoutName == "caves" ? DungeonGenerator::Caves
+		: layoutName == "partitions" ? DungeonGenerator::Partitions : DungeonGenerator::Rooms;
+
+	const std::vector<unsigned int> sizes = { 30u, 64u, 128u, 256u, 512u, 1024u, 2048u, 4096u };
+
+	std::cout << "threads: " << threads.getThreadCount() << ", layout: " << layoutName << "\n"
+			  << std::setw(6) << "size" << std::setw(7) << "maps" << std::setw(12) << "maps/s"
+			  << std::setw(12) << "rooms ms" << std::setw(12) << "carve ms" << std::setw(12) << "walls ms" << std::setw(12) << "load ms"
+			  << std::setw(12) << "peak MiB" << std::setw(12) << "checksum" << std::endl;
+
+	FOREACH(unsigned int size, sizes)
+	{
+		// Keep the amount of generated tiles per size roughly constant
+		auto count = std::max<std::size_t>(1u, iterations * 30u * 30u / (size * size));
+
+		Level level;
+		sf::Time placement, carving, walls, total;
+		unsigned int checksum = 0u;
+		for (auto i = 0u; i < count; ++i)
+		{
+			sf::Clock clock;
+			generator.generate(level, sf::Vector2u(size, size), i + 1u, layout);
+			total += clock.getElapsedTime();
+
+			placement += generator.getStatistics().placement;
+			carving += generator.getStatistics().carving;
+			walls += generator.getStatistics().walls;
+			checksum ^= getChecksum(level);
+		}
+
+		// Load time includes reading every tile once, the mapping only faults pages in on access
+		const std::string filename = "GenerationBenchmark.level";
+		LevelFile::save(level, filename);
+		sf::Clock clock;
+		Level loaded;
+		LevelFile file;
+		file.load(filename, loaded);
+		bool identical = getChecksum(file.getTiles(), loaded.size.x * loaded.size.y) == getChecksum(level);
+		sf::Time load = clock.getElapsedTime();
+		file.close();
+		std::remove(filename.c_str());
+		if (!identical)
+		{
+			std::cerr << "level file does not match the generated level" << std::endl;
+			return 1;
+		}
+
+		auto perMap = [count] (sf::Time time) { return time.asSeconds() * 1000.f / count; };
+		std::cout << std::setw(6) << size << std::setw(7) << count
+				  << std::setw(12) << std::fixed << std::setprecision(2) << count / total.asSeconds()
+				  << std::setw(12) << std::setprecision(3) << perMap(placement)
+				  << std::setw(12) << perMap(carving)
+				  << std::setw(12) << perMap(walls)
+				  << std::setw(12) << load.asSeconds() * 1000.f
+				  << std::setw(12) << std::setprecision(1) << getPeakMemory()
+				  << std::setw(12) << std::hex << checksum << std::dec << std::endl;
+	}
+}
@@ -0,0 +1,79 @@
+#include <Game/DungeonGenerator.hpp>
+#include <Game/Pathfinder.hpp>
+#include <Game/ThreadPool.hpp>
+#include <Game/Foreach.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+// Times path queries between random room tiles on generated maps of
+// increasing size, uncached (plain search) and through the room cache.
+//
+// Usage: PathfindingBenchmark [queries]
+
+int main(int argc, char* argv[])
+{
+	const std::size_t queries = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000u;
+	ThreadPool threads;
+	DungeonGenerator generator(threads);
+
+	const std::vector<unsigned int> sizes = { 64u, 128u, 256u, 512u, 1024u, 2048u };
+
+	std::cout << std::setw(6) << "size" << std::setw(8) << "rooms" << std::setw(9) << "queries"
+			  << std::setw(12) << "search us" << std::setw(12) << "cached us" << std::setw(12) << "waypoints"
+			  << std::setw(10) << "found %" << std::endl;
+
+	FOREACH(unsigned int size, sizes)
+	{
+		Level level;
+		generator.generate(level, sf::Vector2u(size, size), size);
+		BitGrid walkable;
+		generator.computeWalkability(level.tiles.data(), level.size, walkable);
+		Pathfinder pathfinder(level, walkable);
+
+		// Same queries for every run
+		std::default_random_engine random(size);
+		std::vector<std::pair<Tile::ID, Tile::ID>> pairs;
+		auto randomRoomTile = [&level, &random] ()
+		{
+			const sf::IntRect& room = level.rooms[random() % level.rooms.size()];
+			return Tile::ID(room.left + random() % room.width, room.top + random() % room.height);
+		};
+		for (auto i = 0u; i < queries; ++i)
+			pairs.push_back(std::make_pair(randomRoomTile(), randomRoomTile()));
+
+		Pathfinder::Path path;
+		std::size_t found = 0u, waypoints = 0u;
+		sf::Clock clock;
+		FOREACH(auto query, pairs)
+		{
+			if (pathfinder.search(query.first, query.second, path))
+			{
+				++found;
+				waypoints += path.size();
+			}
+		}
+		sf::Time searchTime = clock.restart();
+
+		// Second pass, once the room pairs are in the cache
+		FOREACH(auto query, pairs)
+			pathfinder.findPath(query.first, query.second, path);
+		clock.restart();
+		FOREACH(auto query, pairs)
+			pathfinder.findPath(query.first, query.second, path);
+		sf::Time cachedTime = clock.restart();
+
+		std::cout << std::setw(6) << size << std::setw(8) << level.rooms.size() << std::setw(9) << queries
+				  << std::setw(12) << std::fixed << std::setprecision(2) << searchTime.asMicroseconds() / static_cast<float>(queries)
+				  << std::setw(12) << cachedTime.asMicroseconds() / static_cast<float>(queries)
+				  << std::setw(12) << std::setprecision(1) << waypoints / std::max<float>(1.f, found)
+				  << std::setw(10) << 100.f * found / queries << std::endl;
+	}
+}
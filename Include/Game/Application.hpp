@@ -7,6 +7,7 @@
 #include <Game/StateStack.hpp>
 #include <Game/MusicPlayer.hpp>
 #include <Game/SoundPlayer.hpp>
+#include <Game/ThreadPool.hpp>
 
 #include <SFML/System/Time.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
@@ -39,6 +40,7 @@ class Application
 
 		MusicPlayer				mMusic;
 		SoundPlayer				mSounds;
+		ThreadPool				mThreads;
 		StateStack				mStateStack;
 
 		sf::Text				mStatisticsText;
@@ -0,0 +1,46 @@
+#ifndef GAME_BITGRID_HPP
+#define GAME_BITGRID_HPP
+
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+// One bit per tile, each row padded to whole words so rows can be
+// processed a word at a time. Padding bits are always kept cleared.
+class BitGrid
+{
+	public:
+		typedef std::uint64_t		Word;
+		static const unsigned int	WordBits;
+
+
+	public:
+									BitGrid();
+		explicit					BitGrid(sf::Vector2u size);
+
+		// Resizes and clears every bit
+		void						reset(sf::Vector2u size);
+		sf::Vector2u				getSize() const;
+		std::size_t					getWordsPerRow() const;
+
+		bool						get(unsigned int x, unsigned int y) const;
+		void						set(unsigned int x, unsigned int y, bool value);
+
+		Word*						getRow(unsigned int y);
+		const Word*					getRow(unsigned int y) const;
+		// Mask of the valid bits in the last word of a row
+		Word						getLastWordMask() const;
+
+		static unsigned int			countTrailingZeros(Word word);
+		static unsigned int			countLeadingZeros(Word word);
+
+
+	private:
+		sf::Vector2u				mSize;
+		std::size_t					mWordsPerRow;
+		std::vector<Word>			mWords;
+};
+
+#endif // GAME_BITGRID_HPP
@@ -32,6 +32,10 @@ class Character : public Entity
 		bool					isAllied() const;
 		float					getMaxSpeed() const;
 
+		// Overrides the movement pattern while non-zero
+		void					guideTowards(sf::Vector2f direction);
+		bool					isGuided() const;
+
 		void					playLocalSound(CommandQueue& commands, SoundEffect::ID effect);
 
 
@@ -51,6 +55,7 @@ class Character : public Entity
 
 		float					mTravelledDistance;
 		std::size_t				mDirectionIndex;
+		sf::Vector2f			mGuideDirection;
 };
 
 #endif // GAME_CHARACTER_HPP
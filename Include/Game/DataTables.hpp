@@ -38,7 +38,8 @@ struct CharacterData
 struct TileData
 {
 	Textures::ID					texture;
-	unsigned int 					tilesetIndex;
+	// One per Tile::Variant
+	std::vector<unsigned int>		tilesetIndices;
 };
 
 struct ParticleData
@@ -8,10 +8,14 @@
 #include <Game/Character.hpp>
 #include <Game/Tile.hpp>
 #include <Game/Tilemap.hpp>
+#include <Game/FlowField.hpp>
+#include <Game/FloorManager.hpp>
+#include <Game/SweepAndPrune.hpp>
 #include <Game/CommandQueue.hpp>
 #include <Game/Command.hpp>
 #include <Game/BloomEffect.hpp>
 #include <Game/SoundPlayer.hpp>
+#include <Game/ThreadPool.hpp>
 
 #include <SFML/System/NonCopyable.hpp>
 #include <SFML/Graphics/View.hpp>
@@ -30,7 +34,7 @@ namespace sf
 class Dungeon : private sf::NonCopyable
 {
 	public:
-											Dungeon(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds);
+											Dungeon(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds, ThreadPool& threads, unsigned int seed);
 		void								update(sf::Time dt);
 		void								draw();
 		
@@ -46,10 +50,13 @@ class Dungeon : private sf::NonCopyable
 		void								adaptPlayerPosition();
 		void								adaptPlayerVelocity();
 		void								handleCollisions();
+		void								handleTerrainCollisions(sf::Time dt);
+		void								removeWrecks();
+		void								guideEnemies();
 		void								updateSounds();
 
 		void								buildScene();
-		void								addEnemies();
+		void								enterFloor(FloorManager::Floor floor);
 		void								addEnemy(Character::Type type, float relX, float relY);
     	void								spawnEnemies();
         
@@ -95,15 +102,22 @@ class Dungeon : private sf::NonCopyable
 		TextureHolder						mTextures;
 		FontHolder&							mFonts;
 		SoundPlayer&						mSounds;
+		// Before the scene graph, tilemaps keep references to its thread pools
+		FloorManager						mFloors;
 
 		SceneNode							mSceneGraph;
 		std::array<SceneNode*, LayerCount>	mSceneLayers;
 		CommandQueue						mCommandQueue;
 
 		Tilemap*							mTilemap;
+		Tile::ID							mStairs;
+		FlowField							mFlowField;
+		// Every character in the scene
+		SweepAndPrune						mBroadphase;
 
 		sf::Vector2f						mSpawnPosition;		
 		Character*							mPlayerCharacter;
+		LightMap::LightID					mPlayerLight;
 
 		std::vector<CharacterSpawnPoint>    mEnemySpawnPoints;
 
@@ -0,0 +1,69 @@
+#ifndef GAME_DUNGEONGENERATOR_HPP
+#define GAME_DUNGEONGENERATOR_HPP
+
+#include <Game/Level.hpp>
+#include <Game/BitGrid.hpp>
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <random>
+
+
+class ThreadPool;
+
+class DungeonGenerator : private sf::NonCopyable
+{
+	public:
+		typedef std::default_random_engine RandomEngine;
+
+		enum Layout
+		{
+			// Rectangular rooms joined by straight tunnels
+			Rooms,
+			// The same rooms, opened up by cellular automata caves
+			Caves,
+			// One room per leaf of a binary space partition, halves joined by tunnels
+			Partitions,
+		};
+
+		// Time spent in each stage by the last generate() call
+		struct Statistics
+		{
+			sf::Time			placement;
+			sf::Time			carving;
+			sf::Time			walls;
+		};
+
+
+	public:
+		explicit				DungeonGenerator(ThreadPool& threads);
+
+		// Same seed, same level
+		void					generate(Level& level, unsigned int seed, Layout layout = Rooms);
+		void					generate(Level& level, sf::Vector2u size, unsigned int seed, Layout layout = Rooms);
+
+		// Generation stages, in order
+		void					reset(Level& level, sf::Vector2u size, unsigned int seed);
+		void					placeRooms(Level& level, sf::IntRect area, unsigned int maxRooms, RandomEngine& random);
+		// Partitions only; rooms never overlap and are all connected
+		void					partitionRooms(Level& level, sf::IntRect area, RandomEngine& random);
+		void					carve(Level& level, std::size_t firstRoom = 0u, std::size_t firstTunnel = 0u);
+		// Caves only; keeps the caves reachable from the carved tiles
+		void					growCaves(Level& level, unsigned int steps, RandomEngine& random);
+		void					generateWalls(Level& level);
+
+		// One bit per walkable tile
+		void					computeWalkability(const Tile::Type* tiles, sf::Vector2u size, BitGrid& walkable);
+
+		const Statistics&		getStatistics() const;
+
+
+	private:
+		ThreadPool&				mThreads;
+		Statistics				mStatistics;
+};
+
+#endif // GAME_DUNGEONGENERATOR_HPP
@@ -0,0 +1,46 @@
+#ifndef GAME_FIELDOFVIEW_HPP
+#define GAME_FIELDOFVIEW_HPP
+
+#include <Game/Tile.hpp>
+#include <Game/BitGrid.hpp>
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+
+
+// Tiles in line of sight of a viewpoint, walls block sight. Tiles stay
+// explored once they have been visible.
+class FieldOfView : private sf::NonCopyable
+{
+	public:
+		explicit					FieldOfView(unsigned int radius);
+
+		// Resizes, nothing visible or explored
+		void						reset(sf::Vector2u size);
+		sf::Vector2u				getSize() const;
+
+		// Recursive shadowcasting; tiles whose visibility changed are appended to changed
+		void						compute(const BitGrid& walkable, Tile::ID origin, std::vector<Tile::ID>& changed);
+		bool						isVisible(Tile::ID id) const;
+		bool						isExplored(Tile::ID id) const;
+
+
+	private:
+		void						castLight(const BitGrid& walkable, int row, float start, float end, const int (&transform)[4]);
+		void						reveal(int x, int y);
+
+
+	private:
+		int							mRadius;
+		Tile::ID					mOrigin;
+		BitGrid						mVisible;
+		BitGrid						mExplored;
+		// Visible tiles of the current and the previous computation, to find the changes
+		BitGrid						mPrevious;
+		std::vector<Tile::ID>		mVisibleTiles;
+		std::vector<Tile::ID>		mPreviousTiles;
+};
+
+#endif // GAME_FIELDOFVIEW_HPP
@@ -0,0 +1,56 @@
+#ifndef GAME_FLOORMANAGER_HPP
+#define GAME_FLOORMANAGER_HPP
+
+#include <Game/Tilemap.hpp>
+#include <Game/ThreadPool.hpp>
+#include <Game/ResourceIdentifiers.hpp>
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <future>
+#include <memory>
+#include <vector>
+
+
+// Hands out the floors of the dungeon one after the other. While a floor is
+// played, the next one is built on a background thread, so taking the
+// stairs only has to swap it in.
+class FloorManager : private sf::NonCopyable
+{
+	public:
+		struct Floor
+		{
+			std::unique_ptr<Tilemap>	tilemap;
+			unsigned int				depth;
+			sf::Vector2f				playerSpawn;
+			Tile::ID					stairs;
+			std::vector<sf::Vector2f>	enemySpawns;
+		};
+
+
+	public:
+									FloorManager(const TextureHolder& textures, ThreadPool& threads, unsigned int seed);
+
+		// True if nextFloor() would not have to wait
+		bool						isNextReady() const;
+		// Waits for the next floor if it is not built yet, then starts on the one after
+		Floor						nextFloor();
+
+
+	private:
+		Floor						build(unsigned int depth, ThreadPool& threads) const;
+
+
+	private:
+		const TextureHolder&		mTextures;
+		ThreadPool&					mThreads;
+		// Background floors are built without workers, the other cores are left to the game
+		ThreadPool					mBackgroundThreads;
+		unsigned int				mSeed;
+		unsigned int				mDepth;
+		// Destroying it waits for the floor being built
+		std::future<Floor>			mNext;
+};
+
+#endif // GAME_FLOORMANAGER_HPP
@@ -0,0 +1,49 @@
+#ifndef GAME_FLOWFIELD_HPP
+#define GAME_FLOWFIELD_HPP
+
+#include <Game/Tile.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+
+
+class Tilemap;
+
+// Distance in steps from every tile to a target tile, up to a range.
+// Characters follow it by moving to the neighbour closest to the target.
+class FlowField : private sf::NonCopyable
+{
+	public:
+		static const sf::Uint16		Unreachable;
+
+
+	public:
+		explicit					FlowField(unsigned int range);
+
+		// Recomputes only if the target tile or the map changed, returns true if it did
+		bool						update(const Tilemap& tilemap, Tile::ID target);
+		// Forgets the last target, for a tilemap that was replaced
+		void						clear();
+		sf::Uint16					getDistance(Tile::ID id) const;
+		// Unit vector towards the next tile on the way to the target, zero if out of range
+		sf::Vector2f				getDirection(const Tilemap& tilemap, sf::Vector2f position) const;
+
+
+	private:
+		std::size_t					getIndex(Tile::ID id) const;
+
+
+	private:
+		unsigned int				mRange;
+		Tile::ID					mTarget;
+		unsigned int				mRevision;
+		sf::Vector2u				mSize;
+		std::vector<sf::Uint16>		mDistances;
+		// Tiles reached by the last update, in search order; only these are cleared on the next one
+		std::vector<Tile::ID>		mVisited;
+};
+
+#endif // GAME_FLOWFIELD_HPP
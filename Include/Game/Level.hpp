@@ -0,0 +1,43 @@
+#ifndef GAME_LEVEL_HPP
+#define GAME_LEVEL_HPP
+
+#include <Game/Tile.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <vector>
+
+
+// Generated dungeon data, independent from rendering
+struct Level
+{
+	typedef sf::Uint16			RoomIndex;
+	static const RoomIndex		NoRoom;
+	static const std::size_t	MaxRooms;
+
+
+								Level();
+
+	// Appends a room and marks its tiles
+	void						addRoom(sf::IntRect room);
+	// Rebuilds roomIndices from rooms
+	void						indexRooms();
+	RoomIndex					getRoomIndex(unsigned int x, unsigned int y) const;
+	// True if no room covers any tile of area
+	bool						isFree(sf::IntRect area) const;
+
+
+	unsigned int				seed;
+	sf::Vector2u				size;
+	// Row-major tile types, indexed by x + y * size.x
+	std::vector<Tile::Type>		tiles;
+	std::vector<sf::IntRect>	rooms;
+	// Index in rooms of the room covering each tile, NoRoom elsewhere
+	std::vector<RoomIndex>		roomIndices;
+	std::vector<sf::IntRect>	tunnels;
+	std::vector<sf::Vector2u>	spawns;
+};
+
+#endif // GAME_LEVEL_HPP
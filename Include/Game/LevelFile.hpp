@@ -0,0 +1,75 @@
+#ifndef GAME_LEVELFILE_HPP
+#define GAME_LEVELFILE_HPP
+
+#include <Game/Level.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+
+#include <string>
+
+
+// Binary level format, mapped into memory on load.
+//
+// Layout, native byte order:
+//	Header
+//	Room		roomCount times
+//	Room		tunnelCount times
+//	Spawn		spawnCount times
+//	Tile::Type	width * height times, row-major
+class LevelFile : private sf::NonCopyable
+{
+	public:
+		static const sf::Uint32	Version;
+
+
+	public:
+								LevelFile();
+								~LevelFile();
+
+		static void				save(const Level& level, const std::string& filename);
+
+		// Fills level without its tiles, which stay in the mapping (see getTiles()),
+		// room indices are rebuilt from the rooms
+		void					load(const std::string& filename, Level& level);
+		void					close();
+
+		// Copy-on-write view of the file tiles, edits are never written back
+		Tile::Type*				getTiles();
+
+
+	private:
+		struct Header
+		{
+			char				magic[4];
+			sf::Uint32			version;
+			sf::Uint32			seed;
+			sf::Uint32			width;
+			sf::Uint32			height;
+			sf::Uint32			roomCount;
+			sf::Uint32			tunnelCount;
+			sf::Uint32			spawnCount;
+		};
+
+		struct Room
+		{
+			sf::Int32			left;
+			sf::Int32			top;
+			sf::Int32			width;
+			sf::Int32			height;
+		};
+
+		struct Spawn
+		{
+			sf::Uint32			x;
+			sf::Uint32			y;
+		};
+
+
+	private:
+		char*					mData;
+		std::size_t				mSize;
+		Tile::Type*				mTiles;
+};
+
+#endif // GAME_LEVELFILE_HPP
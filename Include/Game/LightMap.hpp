@@ -0,0 +1,67 @@
+#ifndef GAME_LIGHTMAP_HPP
+#define GAME_LIGHTMAP_HPP
+
+#include <Game/Tile.hpp>
+#include <Game/BitGrid.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Color.hpp>
+
+#include <vector>
+
+
+// Coloured point lights spread over the walkable tiles, fading with every
+// step. Walls next to lit tiles are lit too but do not pass light on. Each
+// light remembers what it added, so it can be moved or removed without
+// recomputing the others.
+class LightMap : private sf::NonCopyable
+{
+	public:
+		typedef std::size_t			LightID;
+
+
+	public:
+									LightMap();
+
+		// After the walkable tiles were reloaded; lights are spread again
+		void						rebuild(const BitGrid& walkable);
+
+		// Tiles whose light changed are appended to changed
+		LightID						addLight(const BitGrid& walkable, Tile::ID position, sf::Color color, unsigned int radius, std::vector<Tile::ID>& changed);
+		void						moveLight(const BitGrid& walkable, LightID light, Tile::ID position, std::vector<Tile::ID>& changed);
+		void						removeLight(LightID light, std::vector<Tile::ID>& changed);
+		// Spreads the lights that may reach a tile again, after it was edited
+		void						updateTile(const BitGrid& walkable, Tile::ID id, std::vector<Tile::ID>& changed);
+
+		// Sum of the ambient color and every light reaching the tile
+		sf::Color					getColor(Tile::ID id, sf::Color ambient) const;
+
+
+	private:
+		struct Light
+		{
+			Tile::ID				position;
+			sf::Color				color;
+			unsigned int			radius;
+			bool					active;
+			// Lit tile indices and their intensity (0-255), in spreading order
+			std::vector<std::pair<std::size_t, sf::Uint8>> tiles;
+		};
+
+
+	private:
+		void						spread(const BitGrid& walkable, Light& light);
+		void						apply(const Light& light, int sign, std::vector<Tile::ID>* changed);
+
+
+	private:
+		sf::Vector2u				mSize;
+		std::vector<Light>			mLights;
+		// Red, green and blue sums of every light, per tile
+		std::vector<sf::Uint16>		mLevels;
+		BitGrid						mVisited;
+};
+
+#endif // GAME_LIGHTMAP_HPP
@@ -0,0 +1,76 @@
+#ifndef GAME_PATHFINDER_HPP
+#define GAME_PATHFINDER_HPP
+
+#include <Game/Level.hpp>
+#include <Game/BitGrid.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+
+// Jump point search over the walkable tiles, 8-connected without cutting wall corners
+class Pathfinder : private sf::NonCopyable
+{
+	public:
+		// Waypoints after the start up to the goal, joined by straight lines
+		typedef std::vector<Tile::ID>	Path;
+
+
+	public:
+										Pathfinder(const Level& level, const BitGrid& walkable);
+
+		// Paths between two rooms go through both room centers and are cached per room pair
+		bool							findPath(Tile::ID start, Tile::ID goal, Path& path);
+		// Uncached, shortest path
+		bool							search(Tile::ID start, Tile::ID goal, Path& path);
+		// Needed whenever walkability or rooms change
+		void							clearCache();
+
+
+	private:
+		typedef std::pair<Level::RoomIndex, Level::RoomIndex>	RoomPair;
+		typedef std::list<std::pair<RoomPair, Path>>			PathCache;
+
+
+	private:
+		void							bindGrid();
+		bool							isWalkable(int x, int y) const;
+		// Jump along row y of grid, which holds columns instead of rows for vertical jumps
+		bool							scanLine(const BitGrid& grid, int& x, int y, int dx, int goalX, int goalY) const;
+		bool							isOpenRoom(Level::RoomIndex room);
+		const Path&						getRoomPath(Level::RoomIndex from, Level::RoomIndex to);
+
+		bool							jumpStraight(int& x, int& y, int dx, int dy) const;
+		bool							jumpDiagonal(int& x, int& y, int dx, int dy) const;
+		void							addJumpPoint(sf::Uint32 from, int dx, int dy);
+
+
+	private:
+		const Level&					mLevel;
+		const BitGrid&					mWalkable;
+		const BitGrid::Word*			mRows;
+		std::size_t						mWordsPerRow;
+		int								mWidth;
+		int								mHeight;
+		// Walkability transposed, so vertical jumps can also test whole words
+		BitGrid							mColumns;
+		bool							mColumnsValid;
+		// Search state reused between queries, a node belongs to the current search if its stamp is recent
+		Tile::ID						mGoal;
+		sf::Uint32						mSearch;
+		std::vector<sf::Uint32>			mStamps;
+		std::vector<float>				mCosts;
+		std::vector<sf::Uint32>			mParents;
+		std::vector<std::pair<float, sf::Uint32>> mOpenList;
+		// Room paths, least recently used last
+		PathCache						mCache;
+		std::map<RoomPair, PathCache::iterator> mCacheLookup;
+		std::vector<signed char>		mOpenRooms;
+};
+
+#endif // GAME_PATHFINDER_HPP
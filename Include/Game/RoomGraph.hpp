@@ -0,0 +1,58 @@
+#ifndef GAME_ROOMGRAPH_HPP
+#define GAME_ROOMGRAPH_HPP
+
+#include <Game/Level.hpp>
+#include <Game/BitGrid.hpp>
+
+#include <vector>
+
+
+// Rooms and the corridors joining them, as carved in a level.
+// A corridor is a connected group of walkable tiles outside of any room,
+// its doors are the corridor tiles next to a room.
+class RoomGraph
+{
+	public:
+		struct Door
+		{
+			Tile::ID						tile;
+			Level::RoomIndex				room;
+		};
+
+		struct Corridor
+		{
+			std::vector<Tile::ID>			tiles;
+			std::vector<Door>				doors;
+			// Sorted, without duplicates
+			std::vector<Level::RoomIndex>	rooms;
+		};
+
+		struct Room
+		{
+			// Sorted, without duplicates
+			std::vector<std::size_t>		corridors;
+			// Rooms sharing a wall-free border with this one
+			std::vector<Level::RoomIndex>	touching;
+			// Rooms reachable from each other share the same component
+			std::size_t						component;
+		};
+
+
+	public:
+											RoomGraph();
+
+		void								build(const Level& level, const BitGrid& walkable);
+
+		const std::vector<Room>&			getRooms() const;
+		const std::vector<Corridor>&		getCorridors() const;
+		// Rooms one corridor or one border away, sorted, without duplicates
+		void								getAdjacentRooms(Level::RoomIndex room, std::vector<Level::RoomIndex>& rooms) const;
+		bool								isConnected(Level::RoomIndex from, Level::RoomIndex to) const;
+
+
+	private:
+		std::vector<Room>					mRooms;
+		std::vector<Corridor>				mCorridors;
+};
+
+#endif // GAME_ROOMGRAPH_HPP
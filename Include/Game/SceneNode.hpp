@@ -9,7 +9,6 @@
 #include <SFML/Graphics/Drawable.hpp>
 
 #include <vector>
-#include <set>
 #include <memory>
 #include <utility>
 
@@ -38,8 +37,6 @@ class SceneNode : public sf::Transformable, public sf::Drawable, private sf::Non
 		void					onCommand(const Command& command, sf::Time dt);
 		virtual unsigned int	getCategory() const;
 
-		void					checkSceneCollision(SceneNode& sceneGraph, std::set<Pair>& collisionPairs);
-		void					checkNodeCollision(SceneNode& node, std::set<Pair>& collisionPairs);
 		void					removeWrecks();
 		virtual sf::FloatRect	getBoundingRect() const;
 		virtual bool			isMarkedForRemoval() const;
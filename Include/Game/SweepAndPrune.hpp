@@ -0,0 +1,97 @@
+#ifndef GAME_SWEEPANDPRUNE_HPP
+#define GAME_SWEEPANDPRUNE_HPP
+
+#include <Game/SceneNode.hpp>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// Broadphase for nodes that mostly keep their place relative to each other.
+// The x extents stay sorted between updates, so an insertion sort only has
+// a few swaps to do, and every swap adds or drops a cached pair. Pairs are
+// ordered by address like std::minmax.
+//
+// Cached pairs live in a flat vector sorted by proxy indices. The sort only
+// records the changes; those are sorted once and merged in, so no memory is
+// allocated per pair. After many inserts the endpoints are sorted from
+// scratch and the pairs found again in one sweep instead.
+class SweepAndPrune : private sf::NonCopyable
+{
+	public:
+									SweepAndPrune();
+
+		// Nodes are tracked until removed, remove them before they are destroyed
+		void						insert(SceneNode& node);
+		// Pairs of the node are dropped without being reported as exited
+		void						remove(SceneNode& node);
+
+		// Reads the bounds of every node again and updates the pairs
+		void						update();
+		// Every overlapping pair, the ones that just entered included
+		const std::vector<SceneNode::Pair>& getPairs() const;
+		// Pairs that started or stopped overlapping in the last update
+		const std::vector<SceneNode::Pair>& getEntered() const;
+		const std::vector<SceneNode::Pair>& getExited() const;
+
+
+	private:
+		struct Proxy
+		{
+			SceneNode*				node;
+			sf::FloatRect			bounds;
+		};
+
+		struct Endpoint
+		{
+			float					value;
+			sf::Uint32				proxy;
+			bool					isMin;
+			// Of a proxy with no width, both its endpoints have the same value
+			bool					isEmpty;
+		};
+
+		// Key of the proxy pair and +1 when it started overlapping on x, -1 when it stopped
+		typedef std::pair<std::uint64_t, int> PairChange;
+
+		// Proxies overlapping on x, and whether their bounds overlap too
+		struct CachedPair
+		{
+			sf::Uint32				first;
+			sf::Uint32				second;
+			bool					overlapping;
+		};
+
+
+	private:
+		void						sortEndpoints();
+		void						sweepEndpoints();
+		// Changes of a pair cancel out, pairs dropped while overlapping are reported as exited
+		void						applyPairChanges();
+		SceneNode::Pair				getNodes(const CachedPair& pair) const;
+
+		static std::uint64_t		getKey(sf::Uint32 first, sf::Uint32 second);
+		static bool					isBefore(const Endpoint& lhs, const Endpoint& rhs);
+
+
+	private:
+		// Slots of removed nodes have no node and are reused
+		std::vector<Proxy>			mProxies;
+		std::vector<sf::Uint32>		mFreeProxies;
+		std::vector<Endpoint>		mEndpoints;
+		std::size_t					mInsertCount;
+		// Sorted by key, mMergedPairs is the buffer the next merge writes to
+		std::vector<CachedPair>		mPairs;
+		std::vector<CachedPair>		mMergedPairs;
+		std::vector<PairChange>		mPairChanges;
+		std::vector<SceneNode::Pair> mOverlapping;
+		std::vector<SceneNode::Pair> mEntered;
+		std::vector<SceneNode::Pair> mExited;
+};
+
+#endif // GAME_SWEEPANDPRUNE_HPP
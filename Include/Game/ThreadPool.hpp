@@ -0,0 +1,42 @@
+#ifndef GAME_THREADPOOL_HPP
+#define GAME_THREADPOOL_HPP
+
+#include <SFML/System/NonCopyable.hpp>
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+class ThreadPool : private sf::NonCopyable
+{
+	public:
+		typedef std::function<void()>							Task;
+		typedef std::function<void(std::size_t, std::size_t)>	RangeTask;
+
+
+	public:
+		explicit					ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
+									~ThreadPool();
+
+		// Splits [0, count) in ranges run across the workers, returns when all are done
+		void						parallelFor(std::size_t count, const RangeTask& task);
+		std::size_t					getThreadCount() const;
+
+
+	private:
+		void						work();
+
+
+	private:
+		std::vector<std::thread>	mThreads;
+		std::queue<Task>			mTasks;
+		std::mutex					mMutex;
+		std::condition_variable		mCondition;
+		bool						mStopping;
+};
+
+#endif // GAME_THREADPOOL_HPP
@@ -1,15 +1,16 @@
 #ifndef GAME_TILE_HPP
 #define GAME_TILE_HPP
 
-#include <Game/SceneNode.hpp>
-#include <Game/ResourceIdentifiers.hpp>
-#include <Game/TextNode.hpp>
+#include <Game/Category.hpp>
 
-#include <SFML/System/Vector2.hpp>
-#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Config.hpp>
 
+#include <utility>
 
-class Tile : public SceneNode
+
+// Plain value describing one tile of a tilemap. The map itself only stores
+// the type byte of each tile, bounds and position come from the tilemap.
+class Tile
 {
 	public:
 		typedef std::pair<unsigned int, unsigned int> ID;
@@ -17,32 +18,58 @@ class Tile : public SceneNode
 
 
 	public:
-		enum Type
+		// One byte per tile, level files store the grid as is
+		enum Type : sf::Uint8
 		{
 			None,
 			Floor,
 			Wall,
 			TunnelFloor,
 			TunnelWall,
+			Stairs,
 			TypeCount,
 		};
 
+		// Bits of the neighbour mask, set when that neighbour is walkable
+		enum Neighbour : sf::Uint8
+		{
+			North 		= 1 << 0,
+			NorthEast 	= 1 << 1,
+			East 		= 1 << 2,
+			SouthEast 	= 1 << 3,
+			South 		= 1 << 4,
+			SouthWest 	= 1 << 5,
+			West 		= 1 << 6,
+			NorthWest 	= 1 << 7,
+		};
+
+		// Tileset variants, picked from the neighbour mask
+		enum Variant
+		{
+			Top,
+			Face,
+			Enclosed,
+			VariantCount,
+		};
+
 	
 	public:
 								Tile(const ID id, Type type);
 
-		virtual unsigned int	getCategory() const;
-		virtual sf::FloatRect	getBoundingRect() const;
-
+		unsigned int			getCategory() const;
 		ID 						getID() const;
 		Type 					getType() const;
 		unsigned int 			getTilesetIndex() const;
 		bool					isWalkable() const;
 
+		static unsigned int		getTilesetIndex(Type type);
+		static unsigned int		getTilesetIndex(Type type, sf::Uint8 neighbours);
+		static bool				isWalkable(Type type);
+
 
 	private:
-		const ID				mId;				
-		const Type				mType;
+		ID						mId;
+		Type					mType;
 };
 
 #endif // GAME_TILE_HPP
@@ -0,0 +1,68 @@
+#ifndef GAME_TILERANGE_HPP
+#define GAME_TILERANGE_HPP
+
+#include <Game/Tile.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+
+
+// Tile IDs of a rectangle, column by column, computed on the fly
+class TileRange
+{
+	public:
+		class Iterator
+		{
+			public:
+									Iterator(sf::IntRect area, int x, int y);
+
+				Tile::ID			operator*() const;
+				Iterator&			operator++();
+				bool				operator!=(const Iterator& other) const;
+
+
+			private:
+				sf::IntRect			mArea;
+				int					mX;
+				int					mY;
+		};
+
+
+	public:
+							TileRange();
+		explicit			TileRange(sf::IntRect area);
+
+		Iterator			begin() const;
+		Iterator			end() const;
+		std::size_t			size() const;
+		bool				empty() const;
+
+
+	private:
+		sf::IntRect			mArea;
+};
+
+// Up to 8 neighbours of a tile, stored in place
+class TileNeighbours
+{
+	public:
+		static const std::size_t Capacity = 8u;
+
+
+	public:
+							TileNeighbours();
+
+		void				push(Tile::ID id);
+
+		const Tile::ID*		begin() const;
+		const Tile::ID*		end() const;
+		std::size_t			size() const;
+
+
+	private:
+		Tile::ID			mIds[Capacity];
+		std::size_t			mSize;
+};
+
+#endif // GAME_TILERANGE_HPP
@@ -3,62 +3,126 @@
 
 #include <Game/SceneNode.hpp>
 #include <Game/Tile.hpp>
+#include <Game/TileRange.hpp>
+#include <Game/Level.hpp>
+#include <Game/LevelFile.hpp>
+#include <Game/DungeonGenerator.hpp>
+#include <Game/Pathfinder.hpp>
+#include <Game/RoomGraph.hpp>
+#include <Game/FieldOfView.hpp>
+#include <Game/LightMap.hpp>
 #include <Game/ResourceIdentifiers.hpp>
 
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 
-#include <map>
 #include <vector>
 #include <memory>
+#include <random>
+#include <string>
 #include <utility>
 
 
+class ThreadPool;
+
 class Tilemap : public SceneNode
 {
 	public:
-		typedef std::shared_ptr<Tile> 			TilePtr;
-		typedef std::unique_ptr<sf::IntRect> 	BoundsPtr;
+		static const unsigned int				ChunkSize;
 
 
 	public:
-										Tilemap(const TextureHolder& textures);
+										Tilemap(const TextureHolder& textures, ThreadPool& threads, unsigned int seed, DungeonGenerator::Layout layout = DungeonGenerator::Rooms);
+										Tilemap(const TextureHolder& textures, ThreadPool& threads, const std::string& filename);
 
 		virtual sf::FloatRect			getBoundingRect() const;
-
-		void							addTile(Tile::ID, Tile::Type type);
-		TilePtr 						getTile(Tile::ID id);
-		TilePtr 						getTile(sf::Vector2f position);
-		void 							getNeighbours(Tile::ID id, std::vector<TilePtr>& neighbours);
-		void 							getNeighbours(sf::Vector2f position, std::vector<TilePtr>& neighbours);
-
-		void							getRoom(Tile::ID id, std::vector<TilePtr>& room);
-		void							getRoom(sf::Vector2f position, std::vector<TilePtr>& room);
-		void							getRooms(std::vector<TilePtr>& room);
-		sf::Vector2f 					getRandomRoomCenter();
+		sf::Vector2u					getSize() const;
+		// Changes whenever tiles are edited or reloaded
+		unsigned int					getRevision() const;
+		// Used from then on, maps built on a background pool are handed the game's pool
+		void							setThreadPool(ThreadPool& threads);
+
+		Tile	 						getTile(Tile::ID id) const;
+		Tile	 						getTile(sf::Vector2f position) const;
+		Tile::ID						getTileID(sf::Vector2f position) const;
+		bool 							validateTile(Tile::ID id) const;
+		sf::FloatRect					getTileBounds(Tile::ID id) const;
+		Tile::Type						getTileType(Tile::ID id) const;
+		// Takes effect immediately, the map image is patched on the next update
+		void							setTileType(Tile::ID id, Tile::Type type);
+		bool							isWalkable(Tile::ID id) const;
+		// Part of motion bounds can travel before touching a solid tile, x first then y; off-map tiles are solid
+		// Bounds already inside a solid tile can only move away from it
+		sf::Vector2f					sweep(sf::FloatRect bounds, sf::Vector2f motion) const;
+		TileNeighbours					getNeighbours(Tile::ID id) const;
+		TileNeighbours					getNeighbours(sf::Vector2f position) const;
+
+		// Empty range outside rooms
+		TileRange						getRoom(Tile::ID id) const;
+		TileRange						getRoom(sf::Vector2f position) const;
+		const std::vector<sf::IntRect>&	getRooms() const;
+		// Level::NoRoom outside rooms
+		Level::RoomIndex				getRoomIndex(Tile::ID id) const;
+		// As generated or loaded, tile edits do not change it
+		const RoomGraph&				getRoomGraph() const;
+		sf::Vector2f 					getRandomSpawnPoint(std::default_random_engine& random);
+		bool							findPath(Tile::ID start, Tile::ID goal, Pathfinder::Path& path);
+
+		// Recomputed only when the viewpoint enters another tile or the map changes
+		void							updateFieldOfView(Tile::ID viewpoint);
+		bool							isVisible(Tile::ID id) const;
+		bool							isExplored(Tile::ID id) const;
+
+		// Baked into the tile colours, the map image is patched on the next update
+		LightMap::LightID				addLight(Tile::ID position, sf::Color color, unsigned int radius);
+		void							moveLight(LightMap::LightID light, Tile::ID position);
+		void							removeLight(LightMap::LightID light);
 
 
 	private:
 		virtual void					drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
 		virtual void 					updateCurrent(sf::Time dt, CommandQueue& commands);
 
-		bool 							validateTile(Tile::ID id);	
+		std::size_t						getIndex(Tile::ID id) const;
+		// Bounds in tiles
+		float							sweepAxis(sf::FloatRect bounds, float motion, bool horizontal) const;
+		bool							isSolid(int x, int y) const;
 
-		void							createRoom(sf::IntRect bounds);
-		void 							createTunnelH(int x1, int x2, int y);
-		void 							createTunnelV(int y1, int y2, int x);
-		void							generateMap();
 		void 							generateMapImage();
+		void							updateQuad(Tile::ID id, sf::Uint8 neighbours);
+		void							setQuad(sf::Vertex* quad, Tile::ID id, unsigned int tilesetIndex) const;
+		sf::Color						getTileColor(Tile::ID id) const;
+		// Walkable bits of count tiles starting left of id, off-map tiles count as solid
+		unsigned int					getWalkableSpan(Tile::ID id, unsigned int count = 3u) const;
+		sf::Uint8						getNeighbourMask(Tile::ID id) const;
+		sf::Vertex*						getQuad(Tile::ID id);
 
 
 	private:
-		const sf::Texture 				mTileset;
-		sf::Vector2u					mSize;		
+		// Owned by the texture holder, tilemaps may be built on other threads
+		const sf::Texture& 				mTileset;
+		// Quad texture coordinates of each tileset index, 4 per tile
+		const std::vector<sf::Vector2f>	mTexCoords;
+		ThreadPool*						mThreads;
+		Level							mLevel;
+		LevelFile						mLevelFile;
+		// Tile grid, either mLevel.tiles or the mapped level file
+		Tile::Type*						mTiles;
+		BitGrid							mWalkable;
+		Pathfinder						mPathfinder;
+		RoomGraph						mRoomGraph;
+		FieldOfView						mFieldOfView;
+		Tile::ID						mViewpoint;
+		unsigned int					mViewRevision;
+		LightMap						mLightMap;
 		sf::FloatRect					mBounds;
-		sf::VertexArray					mImage;
-		std::map<Tile::ID, TilePtr>		mMap;	
-		std::vector<BoundsPtr> 			mRooms;
+		// Map image split in ChunkSize x ChunkSize tile blocks, culled by view
+		sf::Vector2u					mChunkCount;
+		std::vector<sf::VertexArray>	mChunks;
+		std::vector<Tile::ID>			mDirtyTiles;
+		unsigned int					mRevision;
 };
 
 #endif // GAME_TILEMAP_HPP
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <SFML/Graphics/Rect.hpp>
 
 #include <sstream>
+#include <random>
 
 
 namespace sf
@@ -43,6 +44,8 @@ float			toRadian(float degree);
 
 // Random number generation
 int				randomInt(int exclusiveMax);
+int				randomInt(int exclusiveMax, std::default_random_engine& engine);
+unsigned int	randomSeed();
 
 // Vector operations
 float			length(sf::Vector2f vector);
@@ -0,0 +1,96 @@
+#include <Game/BitGrid.hpp>
+
+#include <cassert>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+
+const unsigned int BitGrid::WordBits = 64u;
+
+BitGrid::BitGrid()
+: mSize()
+, mWordsPerRow(0u)
+, mWords()
+{
+}
+
+BitGrid::BitGrid(sf::Vector2u size)
+: mSize()
+, mWordsPerRow(0u)
+, mWords()
+{
+	reset(size);
+}
+
+void BitGrid::reset(sf::Vector2u size)
+{
+	mSize = size;
+	mWordsPerRow = (size.x + WordBits - 1u) / WordBits;
+	mWords.assign(mWordsPerRow * size.y, 0u);
+}
+
+sf::Vector2u BitGrid::getSize() const
+{
+	return mSize;
+}
+
+std::size_t BitGrid::getWordsPerRow() const
+{
+	return mWordsPerRow;
+}
+
+bool BitGrid::get(unsigned int x, unsigned int y) const
+{
+	assert(x < mSize.x && y < mSize.y);
+	return (mWords[y * mWordsPerRow + x / WordBits] >> (x % WordBits)) & 1u;
+}
+
+void BitGrid::set(unsigned int x, unsigned int y, bool value)
+{
+	assert(x < mSize.x && y < mSize.y);
+	Word& word = mWords[y * mWordsPerRow + x / WordBits];
+	Word bit = Word(1u) << (x % WordBits);
+	word = value ? word | bit : word & ~bit;
+}
+
+BitGrid::Word* BitGrid::getRow(unsigned int y)
+{
+	return &mWords[y * mWordsPerRow];
+}
+
+const BitGrid::Word* BitGrid::getRow(unsigned int y) const
+{
+	return &mWords[y * mWordsPerRow];
+}
+
+BitGrid::Word BitGrid::getLastWordMask() const
+{
+	auto used = mSize.x % WordBits;
+	return used == 0u ? ~Word(0u) : (Word(1u) << used) - 1u;
+}
+
+unsigned int BitGrid::countTrailingZeros(Word word)
+{
+	assert(word != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return index;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+unsigned int BitGrid::countLeadingZeros(Word word)
+{
+	assert(word != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return WordBits - 1u - index;
+#else
+	return __builtin_clzll(word);
+#endif
+}
@@ -24,6 +24,7 @@ Character::Character(Type type, const TextureHolder& textures, const FontHolder&
 , mSprite(textures.get(Table[type].texture), Table[type].textureRect)
 , mTravelledDistance(0.f)
 , mDirectionIndex(0)
+, mGuideDirection()
 {
 	centerOrigin(mSprite);
 }
@@ -84,6 +85,16 @@ float Character::getMaxSpeed() const
 	return Table[mType].speed;
 }
 
+void Character::guideTowards(sf::Vector2f direction)
+{
+	mGuideDirection = direction;
+}
+
+bool Character::isGuided() const
+{
+	return mGuideDirection.x != 0.f || mGuideDirection.y != 0.f;
+}
+
 void Character::playLocalSound(CommandQueue& commands, SoundEffect::ID effect)
 {
 	sf::Vector2f worldPosition = getWorldPosition();
@@ -101,6 +112,12 @@ void Character::playLocalSound(CommandQueue& commands, SoundEffect::ID effect)
 
 void Character::updateMovementPattern(sf::Time dt)
 {
+	if (isGuided())
+	{
+		setVelocity(getMaxSpeed() * mGuideDirection);
+		return;
+	}
+
 	const std::vector<Direction>& directions = Table[mType].directions;
 	if (!directions.empty())
 	{
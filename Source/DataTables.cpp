@@ -38,19 +38,22 @@ std::vector<TileData> initializeTileData()
 	std::vector<TileData> data(Tile::TypeCount);
 
 	data[Tile::None].texture = Textures::Tiles;
-	data[Tile::None].tilesetIndex = 16;
+	data[Tile::None].tilesetIndices = { 16, 16, 16 };
 
 	data[Tile::Floor].texture = Textures::Tiles;
-	data[Tile::Floor].tilesetIndex = 3;
+	data[Tile::Floor].tilesetIndices = { 3, 3, 3 };
 
 	data[Tile::Wall].texture = Textures::Tiles;
-	data[Tile::Wall].tilesetIndex = 21;
+	data[Tile::Wall].tilesetIndices = { 21, 22, 16 };
 
 	data[Tile::TunnelFloor].texture = Textures::Tiles;
-	data[Tile::TunnelFloor].tilesetIndex = 0;
+	data[Tile::TunnelFloor].tilesetIndices = { 0, 0, 0 };
 
 	data[Tile::TunnelWall].texture = Textures::Tiles;
-	data[Tile::TunnelWall].tilesetIndex = 19;
+	data[Tile::TunnelWall].tilesetIndices = { 19, 20, 16 };
+
+	data[Tile::Stairs].texture = Textures::Tiles;
+	data[Tile::Stairs].tilesetIndices = { 24, 24, 24 };
 
 	return data;
 }
@@ -12,19 +12,35 @@
 #include <limits>
 
 
-Dungeon::Dungeon(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds)
+namespace
+{
+	// Enemies further than this, in tiles, keep their movement pattern
+	const unsigned int ChaseRange = 24u;
+
+	// Follows the player, radius in tiles
+	const sf::Color PlayerLightColor(200, 190, 150);
+	const unsigned int PlayerLightRadius = 7u;
+}
+
+
+Dungeon::Dungeon(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer& sounds, ThreadPool& threads, unsigned int seed)
 : mTarget(outputTarget)
 , mSceneTexture()
 , mView(outputTarget.getDefaultView())
 , mTextures() 
 , mFonts(fonts)
 , mSounds(sounds)
+, mFloors(mTextures, threads, seed)
 , mSceneGraph()
 , mSceneLayers()
 , mCommandQueue()
 , mTilemap()
+, mStairs()
+, mFlowField(ChaseRange)
+, mBroadphase()
 , mSpawnPosition()
 , mPlayerCharacter(nullptr)
+, mPlayerLight()
 , mEnemySpawnPoints()
 , mBloomEffect()
 {	
@@ -37,8 +53,16 @@ Dungeon::Dungeon(sf::RenderTarget& outputTarget, FontHolder& fonts, SoundPlayer&
 
 void Dungeon::update(sf::Time dt)
 {	
+	// The next floor was prepared in the background, taking the stairs just swaps it in
+	if (mTilemap->getTileID(mPlayerCharacter->getWorldPosition()) == mStairs && mFloors.isNextReady())
+		enterFloor(mFloors.nextFloor());
+
 	adaptViewPosition();
+	auto playerTile = mTilemap->getTileID(mPlayerCharacter->getWorldPosition());
+	mTilemap->updateFieldOfView(playerTile);
+	mTilemap->moveLight(mPlayerLight, playerTile);
 	destroyEntitiesOutsideView();
+	guideEnemies();
 
 	while (!mCommandQueue.isEmpty())
 		mSceneGraph.onCommand(mCommandQueue.pop(), dt);
@@ -46,10 +70,11 @@ void Dungeon::update(sf::Time dt)
 
 	handleCollisions();
 
-	mSceneGraph.removeWrecks();
+	removeWrecks();
 	spawnEnemies();
 
 	mSceneGraph.update(dt, mCommandQueue);
+	handleTerrainCollisions(dt);
 	adaptPlayerPosition();
 	mPlayerCharacter->setVelocity(0.f, 0.f);	
 }
@@ -139,10 +164,9 @@ bool matchesCategories(SceneNode::Pair& colliders, Category::Type type1, Categor
 	}
 }
 
-void handleBoundsCollision(SceneNode& lhs, SceneNode& rhs)
+void handleBoundsCollision(SceneNode& lhs, sf::FloatRect rhsBounds, sf::Vector2f rhsPosition, const Tilemap& tilemap)
 {
 	auto lhsBounds 			= lhs.getBoundingRect();
-	auto rhsBounds 			= rhs.getBoundingRect();
 	// check X axis penetration through left or right
 	auto penetrationX		= std::min(std::abs(rhsBounds.left + rhsBounds.width - lhsBounds.left) 
 										, std::abs(lhsBounds.left + lhsBounds.width - rhsBounds.left));
@@ -154,56 +178,50 @@ void handleBoundsCollision(SceneNode& lhs, SceneNode& rhs)
 	auto penetratingX 		= penetratingAxis < penetrationY;
 
 	auto lhsPosition 		= lhs.getPosition();			
-	auto rhsPosition 		= rhs.getPosition();
 	// adjust positions, Tile does not have centralized origin
 	if (lhsPosition.x == lhsBounds.left || lhsPosition.y == lhsBounds.top)
 		lhsPosition = sf::Vector2f(lhsBounds.left + Tile::Size / 2.f, lhsBounds.top + Tile::Size / 2.f);
 	if (rhsPosition.x == rhsBounds.left || rhsPosition.y == rhsBounds.top)
 		rhsPosition = sf::Vector2f(rhsBounds.left + Tile::Size / 2.f, rhsBounds.top + Tile::Size / 2.f);
 
+	sf::Vector2f target;
 	if (penetratingX)
 	{
 		// Colliding Left
 		if (lhsPosition.x > rhsPosition.x)
-			lhs.setPosition(lhsPosition.x + penetrationX, lhsPosition.y);
+			target = sf::Vector2f(lhsPosition.x + penetrationX, lhsPosition.y);
 		// Colliding Right
 		else
-			lhs.setPosition(lhsPosition.x - penetrationX, lhsPosition.y);
+			target = sf::Vector2f(lhsPosition.x - penetrationX, lhsPosition.y);
 	}
 	else
 	{
 		// Colliding Top 
 		if (lhsPosition.y > rhsPosition.y)
-			lhs.setPosition(lhsPosition.x, lhsPosition.y + penetrationY);
+			target = sf::Vector2f(lhsPosition.x, lhsPosition.y + penetrationY);
 		// Colliding Bottom
 		else
-			lhs.setPosition(lhsPosition.x, lhsPosition.y - penetrationY);
-	}			
+			target = sf::Vector2f(lhsPosition.x, lhsPosition.y - penetrationY);
+	}
+
+	// The push is swept like any other step, so it never ends inside a wall
+	lhs.move(tilemap.sweep(lhsBounds, target - lhs.getPosition()));
+}
+
+void handleBoundsCollision(SceneNode& lhs, SceneNode& rhs, const Tilemap& tilemap)
+{
+	handleBoundsCollision(lhs, rhs.getBoundingRect(), rhs.getPosition(), tilemap);
 }
 
 void Dungeon::handleCollisions()
 {
-	std::set<SceneNode::Pair> collisionPairs;
-	mSceneGraph.checkSceneCollision(mSceneGraph, collisionPairs);	
-	FOREACH(SceneNode::Pair pair, collisionPairs)
-	{	
-		if (matchesCategories(pair, Category::Character, Category::Tilemap))
-		{
-			auto& character = static_cast<Character&>(*pair.first);
-			std::vector<Tilemap::TilePtr> neighbours;
-			neighbours.push_back(mTilemap->getTile(character.getPosition()));
-			mTilemap->getNeighbours(character.getPosition(), neighbours);
-			FOREACH (auto tile, neighbours)
-			{
-				if (!tile->isWalkable() && tile->getBoundingRect().intersects(character.getBoundingRect()))
-				{
-					handleBoundsCollision(character, static_cast<SceneNode&>(*tile));
-				}
-			}		
-		}
+	mBroadphase.update();
 
-		if (matchesCategories(pair, Category::Character, Category::Character))
-			handleBoundsCollision(*pair.first, *pair.second);
+	// A hit counts once per contact
+	FOREACH(SceneNode::Pair pair, mBroadphase.getEntered())
+	{
+		if (pair.first->isDestroyed() || pair.second->isDestroyed())
+			continue;
 
 		if (matchesCategories(pair, Category::PlayerCharacter, Category::EnemyCharacter))
 		{
@@ -213,7 +231,61 @@ void Dungeon::handleCollisions()
 			character.damage(enemy.getHitpoints());
 			enemy.destroy();
 		}
-	}	
+	}
+
+	// Characters keep pushing each other apart as long as they overlap
+	FOREACH(SceneNode::Pair pair, mBroadphase.getPairs())
+	{
+		if (!pair.first->isDestroyed() && !pair.second->isDestroyed())
+			handleBoundsCollision(*pair.first, *pair.second, *mTilemap);
+	}
+}
+
+void Dungeon::handleTerrainCollisions(sf::Time dt)
+{
+	// Characters stepped by velocity * dt in the update; the step is taken back and swept through the walkable tiles
+	Command sweeper;
+	sweeper.category = Category::Character;
+	sweeper.action = derivedAction<Character>([this, dt] (Character& character, sf::Time)
+	{
+		if (character.isDestroyed())
+			return;
+
+		auto motion = character.getVelocity() * dt.asSeconds();
+		character.move(-motion);
+		character.move(mTilemap->sweep(character.getBoundingRect(), motion));
+	});
+	mSceneGraph.onCommand(sweeper, dt);
+}
+
+void Dungeon::removeWrecks()
+{
+	// The broadphase lets go of characters before they are deleted
+	Command wreckCollector;
+	wreckCollector.category = Category::Character;
+	wreckCollector.action = derivedAction<Character>([this] (Character& character, sf::Time)
+	{
+		if (character.isMarkedForRemoval())
+			mBroadphase.remove(character);
+	});
+	mSceneGraph.onCommand(wreckCollector, sf::Time::Zero);
+
+	mSceneGraph.removeWrecks();
+}
+
+void Dungeon::guideEnemies()
+{
+	// The field only changes when the player enters another tile
+	mFlowField.update(*mTilemap, mTilemap->getTileID(mPlayerCharacter->getWorldPosition()));
+
+	Command enemyGuider;
+	enemyGuider.category = Category::EnemyCharacter;
+	enemyGuider.action = derivedAction<Character>([this] (Character& enemy, sf::Time)
+	{
+		enemy.guideTowards(mFlowField.getDirection(*mTilemap, enemy.getWorldPosition()));
+	});
+
+	mCommandQueue.push(enemyGuider);
 }
 
 void Dungeon::updateSounds()
@@ -235,48 +307,54 @@ void Dungeon::buildScene()
 
 		mSceneGraph.attachChild(std::move(layer));
 	}
-	// Build Map
-	std::unique_ptr<Tilemap> tilemap(new Tilemap(mTextures));
-	mTilemap = tilemap.get();
-	mTilemap->setPosition(0.f, 0.f);
-	mSceneLayers[Background]->attachChild(std::move(tilemap));
-
 	// Add player's character
 	std::unique_ptr<Character> player(new Character(Character::Player, mTextures, mFonts));
 	mPlayerCharacter = player.get();
-	mSpawnPosition = mTilemap->getRandomRoomCenter();
-	mPlayerCharacter->setPosition(mSpawnPosition);
+	mBroadphase.insert(*player);
 	mSceneLayers[Main]->attachChild(std::move(player));
 
-	addEnemies();
+	enterFloor(mFloors.nextFloor());
 }
 
-void Dungeon::addEnemy(Character::Type type, float x, float y)
+void Dungeon::enterFloor(FloorManager::Floor floor)
 {
-	CharacterSpawnPoint spawn(type, x, y);
-	mEnemySpawnPoints.push_back(spawn);
-}
-
-void Dungeon::addEnemies()
-{
-	auto roomRandomFactor = 2;
-	// TODO: max number of enemies to spawn, better room access (Tilemap API) and distribution
-	std::vector<Tilemap::TilePtr> roomTiles;
-	mTilemap->getRooms(roomTiles);
-	for (auto i = 0u; i < roomTiles.size(); i += 1 + randomInt(roomRandomFactor))
+	// Enemies of the previous floor are dropped, spawned or not
+	Command enemyRemover;
+	enemyRemover.category = Category::EnemyCharacter;
+	enemyRemover.action = derivedAction<Character>([] (Character& enemy, sf::Time)
 	{
-		// chance % of spawning enemy; TODO: create function!
-		auto chance = 0.05f;
-		if ((randomInt(101)) / 100.f >= 1.f - chance)
-			addEnemy(Character::Slime, roomTiles[i]->getBoundingRect().left, roomTiles[i]->getBoundingRect().top);			
-	}
+		enemy.remove();
+	});
+	mSceneGraph.onCommand(enemyRemover, sf::Time::Zero);
+	removeWrecks();
+	mEnemySpawnPoints.clear();
+
+	if (mTilemap)
+		mSceneLayers[Background]->detachChild(*mTilemap);
+	mTilemap = floor.tilemap.get();
+	mSceneLayers[Background]->attachChild(std::move(floor.tilemap));
+	mFlowField.clear();
+	mStairs = floor.stairs;
+
+	mSpawnPosition = floor.playerSpawn;
+	mPlayerCharacter->setPosition(mSpawnPosition);
+	mPlayerLight = mTilemap->addLight(mTilemap->getTileID(mSpawnPosition), PlayerLightColor, PlayerLightRadius);
+
+	FOREACH(sf::Vector2f position, floor.enemySpawns)
+		addEnemy(Character::Slime, position.x, position.y);
 
 	std::sort(mEnemySpawnPoints.begin(), mEnemySpawnPoints.end(), [] (CharacterSpawnPoint lhs, CharacterSpawnPoint rhs)
 	{
-		return lhs.x < rhs.x && lhs.y < rhs.y;
+		return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
 	});
 }
 
+void Dungeon::addEnemy(Character::Type type, float x, float y)
+{
+	CharacterSpawnPoint spawn(type, x, y);
+	mEnemySpawnPoints.push_back(spawn);
+}
+
 void Dungeon::spawnEnemies()
 {
 	// TODO: use list instead of vector
@@ -289,6 +367,7 @@ void Dungeon::spawnEnemies()
 		{
 			std::unique_ptr<Character> enemy(new Character(spawn.type, mTextures, mFonts));
 			enemy->setPosition(spawn.x, spawn.y);
+			mBroadphase.insert(*enemy);
 			mSceneLayers[Main]->attachChild(std::move(enemy));
 
 			spawnedPoints.push_back(itr);
@@ -0,0 +1,547 @@
+#include <Game/DungeonGenerator.hpp>
+#include <Game/ThreadPool.hpp>
+#include <Game/Utility.hpp>
+#include <Game/Foreach.hpp>
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+
+namespace
+{
+	typedef BitGrid::Word Word;
+
+	// Cellular automaton rounds smoothing the cave noise
+	const unsigned int CaveSteps = 4u;
+
+	// Room sizes of placeRooms()
+	const int MinRoomSize = 3;
+	const int MaxRoomSize = 12;
+	// Partition leaves are split until no side is longer than twice this
+	const int MinLeafSize = 7;
+	// Halves of at least this many tiles are built on different workers
+	const int ParallelArea = 128 * 128;
+
+	// Rooms and tunnels of a partition subtree, in the same order whatever the thread count
+	struct Partition
+	{
+		std::vector<sf::IntRect>	rooms;
+		std::vector<sf::IntRect>	tunnels;
+	};
+
+	enum Side
+	{
+		West,
+		East,
+		North,
+		South,
+	};
+
+	// Index of the room of a subtree reaching furthest towards each side
+	typedef std::array<std::size_t, 4> Extremes;
+
+	void createTunnelH(std::vector<sf::IntRect>& tunnels, int x1, int x2, int y)
+	{
+		tunnels.push_back(sf::IntRect(std::min(x1, x2), y, std::abs(x2 - x1) + 1, 1));
+	}
+
+	void createTunnelV(std::vector<sf::IntRect>& tunnels, int y1, int y2, int x)
+	{
+		tunnels.push_back(sf::IntRect(x, std::min(y1, y2), 1, std::abs(y2 - y1) + 1));
+	}
+
+	Extremes partition(ThreadPool& threads, Partition& out, sf::IntRect area, unsigned int seed, int minLeaf)
+	{
+		DungeonGenerator::RandomEngine random(seed);
+		Extremes extremes;
+
+		if (area.width <= 2 * minLeaf && area.height <= 2 * minLeaf)
+		{
+			// Leaf, its room keeps off the edges so rooms of different leaves never touch
+			assert(area.width - 2 >= MinRoomSize && area.height - 2 >= MinRoomSize);
+			auto width 	= MinRoomSize + randomInt(std::min(MaxRoomSize, area.width - 2) - MinRoomSize + 1, random);
+			auto height = MinRoomSize + randomInt(std::min(MaxRoomSize, area.height - 2) - MinRoomSize + 1, random);
+			auto x 		= area.left + 1 + randomInt(area.width - 1 - width, random);
+			auto y 		= area.top + 1 + randomInt(area.height - 1 - height, random);
+			out.rooms.push_back(sf::IntRect(x, y, width, height));
+			extremes.fill(out.rooms.size() - 1u);
+			return extremes;
+		}
+
+		// Cut across the longer side, both halves at least minLeaf long
+		auto vertical = area.width >= area.height;
+		auto length = vertical ? area.width : area.height;
+		auto cut = minLeaf + randomInt(length - 2 * minLeaf + 1, random);
+		sf::IntRect first(area), second(area);
+		if (vertical)
+		{
+			first.width = cut;
+			second.left += cut;
+			second.width -= cut;
+		}
+		else
+		{
+			first.height = cut;
+			second.top += cut;
+			second.height -= cut;
+		}
+		auto firstSeed 	= static_cast<unsigned int>(random());
+		auto secondSeed = static_cast<unsigned int>(random());
+
+		Extremes firstExtremes, secondExtremes;
+		if (area.width * area.height >= ParallelArea)
+		{
+			// The second half is built aside and appended after the first
+			Partition aside;
+			threads.parallelFor(2u, [&] (std::size_t begin, std::size_t end)
+			{
+				for (auto i = begin; i < end; ++i)
+				{
+					if (i == 0u)
+						firstExtremes = partition(threads, out, first, firstSeed, minLeaf);
+					else
+						secondExtremes = partition(threads, aside, second, secondSeed, minLeaf);
+				}
+			});
+
+			FOREACH(std::size_t& index, secondExtremes)
+				index += out.rooms.size();
+			out.rooms.insert(out.rooms.end(), aside.rooms.begin(), aside.rooms.end());
+			out.tunnels.insert(out.tunnels.end(), aside.tunnels.begin(), aside.tunnels.end());
+		}
+		else
+		{
+			firstExtremes = partition(threads, out, first, firstSeed, minLeaf);
+			secondExtremes = partition(threads, out, second, secondSeed, minLeaf);
+		}
+
+		// Join the rooms of both halves closest to the cut
+		auto from 	= getCenter(out.rooms[firstExtremes[vertical ? East : South]]);
+		auto to 	= getCenter(out.rooms[secondExtremes[vertical ? West : North]]);
+		if (randomInt(2, random))
+		{
+			createTunnelH(out.tunnels, from.x, to.x, from.y);
+			createTunnelV(out.tunnels, from.y, to.y, to.x);
+		}
+		else
+		{
+			createTunnelV(out.tunnels, from.y, to.y, from.x);
+			createTunnelH(out.tunnels, from.x, to.x, to.y);
+		}
+
+		auto right 	= [&out] (std::size_t i) { return out.rooms[i].left + out.rooms[i].width; };
+		auto bottom = [&out] (std::size_t i) { return out.rooms[i].top + out.rooms[i].height; };
+		extremes[West] 	= out.rooms[secondExtremes[West]].left < out.rooms[firstExtremes[West]].left ? secondExtremes[West] : firstExtremes[West];
+		extremes[East] 	= right(secondExtremes[East]) > right(firstExtremes[East]) ? secondExtremes[East] : firstExtremes[East];
+		extremes[North] = out.rooms[secondExtremes[North]].top < out.rooms[firstExtremes[North]].top ? secondExtremes[North] : firstExtremes[North];
+		extremes[South] = bottom(secondExtremes[South]) > bottom(firstExtremes[South]) ? secondExtremes[South] : firstExtremes[South];
+		return extremes;
+	}
+
+	// Bit x of the result is bit x - 1 of the row, the tile west of x
+	Word getWest(const Word* row, std::size_t word)
+	{
+		return (row[word] << 1) | (word > 0u ? row[word - 1u] >> (BitGrid::WordBits - 1u) : 0u);
+	}
+
+	Word getEast(const Word* row, std::size_t word, std::size_t words)
+	{
+		return (row[word] >> 1) | (word + 1u < words ? row[word + 1u] << (BitGrid::WordBits - 1u) : 0u);
+	}
+
+	void addBits(Word a, Word b, Word c, Word& sum, Word& carry)
+	{
+		sum = a ^ b ^ c;
+		carry = (a & b) | (c & (a ^ b));
+	}
+
+	// Spreads bits of seeds over the set bits of open they touch, towards the high bits
+	Word fillHigh(Word seeds, Word open)
+	{
+		for (auto shift = 1u; shift < BitGrid::WordBits; shift *= 2u)
+		{
+			seeds |= open & (seeds << shift);
+			open &= open << shift;
+		}
+		return seeds;
+	}
+
+	Word fillLow(Word seeds, Word open)
+	{
+		for (auto shift = 1u; shift < BitGrid::WordBits; shift *= 2u)
+		{
+			seeds |= open & (seeds >> shift);
+			open &= open >> shift;
+		}
+		return seeds;
+	}
+
+	// Reached tiles spread along the open runs of a row, across words
+	void fillRow(Word* reached, const Word* open, std::size_t words)
+	{
+		for (auto word = 0u; word < words; ++word)
+		{
+			if (word > 0u)
+				reached[word] |= (reached[word - 1u] >> (BitGrid::WordBits - 1u)) & open[word];
+			reached[word] = fillHigh(reached[word], open[word]);
+		}
+		for (auto word = words; word-- > 0u; )
+		{
+			if (word + 1u < words)
+				reached[word] |= (reached[word + 1u] << (BitGrid::WordBits - 1u)) & open[word];
+			reached[word] = fillLow(reached[word], open[word]);
+		}
+	}
+}
+
+DungeonGenerator::DungeonGenerator(ThreadPool& threads)
+: mThreads(threads)
+, mStatistics()
+{
+}
+
+void DungeonGenerator::generate(Level& level, unsigned int seed, Layout layout)
+{
+	// TODO: improve generation...
+	RandomEngine random(seed);
+	int randomFactor = 2;
+	int randomFactorX = 1 + randomInt(randomFactor, random);
+	int randomFactorY = 1 + randomInt(randomFactor, random);
+	reset(level, sf::Vector2u(10u + 10 * randomFactorX, 10u + 10 * randomFactorY), seed);
+
+	sf::Clock clock;
+	auto maxRooms = std::max(level.size.x, level.size.y) / std::min(randomFactorX, randomFactorY);
+	// Caves leave less room for rooms
+	if (layout == Caves)
+		maxRooms /= 2u;
+	if (layout == Partitions)
+		partitionRooms(level, sf::IntRect(1, 1, level.size.x - 2, level.size.y - 2), random);
+	else
+		placeRooms(level, sf::IntRect(0, 0, level.size.x, level.size.y), maxRooms, random);
+	mStatistics.placement = clock.restart();
+	carve(level);
+	if (layout == Caves)
+		growCaves(level, CaveSteps, random);
+	mStatistics.carving = clock.restart();
+	generateWalls(level);
+	mStatistics.walls = clock.restart();
+}
+
+void DungeonGenerator::generate(Level& level, sf::Vector2u size, unsigned int seed, Layout layout)
+{
+	RandomEngine random(seed);
+	reset(level, size, seed);
+
+	sf::Clock clock;
+	auto maxRooms = std::max(size.x, size.y);
+	if (layout == Caves)
+		maxRooms /= 2u;
+	if (layout == Partitions)
+		partitionRooms(level, sf::IntRect(1, 1, size.x - 2, size.y - 2), random);
+	else
+		placeRooms(level, sf::IntRect(0, 0, size.x, size.y), maxRooms, random);
+	mStatistics.placement = clock.restart();
+	carve(level);
+	if (layout == Caves)
+		growCaves(level, CaveSteps, random);
+	mStatistics.carving = clock.restart();
+	generateWalls(level);
+	mStatistics.walls = clock.restart();
+}
+
+const DungeonGenerator::Statistics& DungeonGenerator::getStatistics() const
+{
+	return mStatistics;
+}
+
+void DungeonGenerator::reset(Level& level, sf::Vector2u size, unsigned int seed)
+{
+	level.seed = seed;
+	level.size = size;
+	// Fills the map, easier to manage
+	level.tiles.assign(size.x * size.y, Tile::Type::None);
+	level.rooms.clear();
+	level.roomIndices.assign(size.x * size.y, Level::NoRoom);
+	level.tunnels.clear();
+	level.spawns.clear();
+}
+
+void DungeonGenerator::placeRooms(Level& level, sf::IntRect area, unsigned int maxRooms, RandomEngine& random)
+{
+	auto roomMinSize 	= 3u;
+	auto roomMaxSize 	= 10u;
+	auto numberRooms 	= 0u;
+	// Generate Rooms (Floor)
+	for (auto i = 0u; i < maxRooms && level.rooms.size() < Level::MaxRooms; ++i)
+	{
+        auto width 	= roomMinSize + randomInt(roomMaxSize, random);
+        auto height = roomMinSize + randomInt(roomMaxSize, random);
+        auto x 		= area.left + randomInt(area.width - width - 1, random);
+        auto y 		= area.top + randomInt(area.height - height - 1, random);
+
+        sf::IntRect newRoom(x, y, width, height);
+		if (level.isFree(newRoom))
+		{
+			auto newRoomCenter = getCenter(newRoom);
+			if (numberRooms > 0)
+			{
+				auto previousRoomCenter = getCenter(level.rooms.back());
+				
+	            if (randomInt(2, random))
+	            {
+	                createTunnelH(level.tunnels, previousRoomCenter.x, newRoomCenter.x, previousRoomCenter.y);
+	                createTunnelV(level.tunnels, previousRoomCenter.y, newRoomCenter.y, newRoomCenter.x);
+	            }
+	            else
+	            {
+	                createTunnelV(level.tunnels, previousRoomCenter.y, newRoomCenter.y, previousRoomCenter.x);
+	                createTunnelH(level.tunnels, previousRoomCenter.x, newRoomCenter.x, newRoomCenter.y);
+				}				
+			}	
+			level.addRoom(newRoom);
+			level.spawns.push_back(sf::Vector2u(newRoomCenter.x, newRoomCenter.y));
+			++numberRooms;	
+		}			
+	}
+}
+
+void DungeonGenerator::partitionRooms(Level& level, sf::IntRect area, RandomEngine& random)
+{
+	// Larger leaves on huge maps, every room needs an index
+	auto minLeaf = MinLeafSize;
+	while (static_cast<std::size_t>(area.width / minLeaf) * static_cast<std::size_t>(area.height / minLeaf) > Level::MaxRooms)
+		++minLeaf;
+
+	Partition result;
+	partition(mThreads, result, area, static_cast<unsigned int>(random()), minLeaf);
+
+	FOREACH(const sf::IntRect& room, result.rooms)
+	{
+		auto center = getCenter(room);
+		level.addRoom(room);
+		level.spawns.push_back(sf::Vector2u(center.x, center.y));
+	}
+	level.tunnels.insert(level.tunnels.end(), result.tunnels.begin(), result.tunnels.end());
+}
+
+void DungeonGenerator::carve(Level& level, std::size_t firstRoom, std::size_t firstTunnel)
+{
+	const auto size = level.size;
+	// Each band only writes its own rows, rooms first then tunnels, so the result does not depend on the thread count
+	mThreads.parallelFor(size.y, [&level, size, firstRoom, firstTunnel] (std::size_t top, std::size_t bottom)
+	{
+		for (auto i = firstRoom; i < level.rooms.size(); ++i)
+		{
+			const sf::IntRect& room = level.rooms[i];
+			auto begin 	= std::max(room.top, static_cast<int>(top));
+			auto end 	= std::min(room.top + room.height, static_cast<int>(bottom));
+			for (auto y = begin; y < end; ++y)
+				for (auto x = room.left; x < room.left + room.width; ++x)
+				{
+					auto onBorder = x == 0 || y == 0 || x + 1u == size.x || y + 1u == size.y;
+					level.tiles[x + y * size.x] = onBorder ? Tile::Type::Wall : Tile::Type::Floor;
+				}
+		}
+
+		for (auto i = firstTunnel; i < level.tunnels.size(); ++i)
+		{
+			const sf::IntRect& tunnel = level.tunnels[i];
+			auto begin 	= std::max(tunnel.top, static_cast<int>(top));
+			auto end 	= std::min(tunnel.top + tunnel.height, static_cast<int>(bottom));
+			for (auto y = begin; y < end; ++y)
+				for (auto x = tunnel.left; x < tunnel.left + tunnel.width; ++x)
+					level.tiles[x + y * size.x] = Tile::Type::Floor;
+		}
+	});
+}
+
+void DungeonGenerator::growCaves(Level& level, unsigned int steps, RandomEngine& random)
+{
+	const auto size = level.size;
+	BitGrid open(size);
+	BitGrid next(size);
+	const auto words = open.getWordsPerRow();
+	// Valid bits of the last word, without the last column
+	const auto lastWordMask = open.getLastWordMask() >> 1;
+
+	// Noise with 9 open tiles out of 16, the map border stays closed
+	std::independent_bits_engine<RandomEngine, 64, Word> bits(random());
+	for (auto y = 1u; y + 1u < size.y; ++y)
+	{
+		Word* row = open.getRow(y);
+		for (auto word = 0u; word < words; ++word)
+		{
+			Word a = bits(), b = bits(), c = bits();
+			row[word] = bits() | (a & b & c);
+		}
+		row[0] &= ~Word(1u);
+		row[words - 1u] &= lastWordMask;
+	}
+
+	// A tile is open next round with 5 or more open neighbours, or 4 if it is open already
+	for (auto step = 0u; step < steps; ++step)
+	{
+		mThreads.parallelFor(size.y, [&] (std::size_t top, std::size_t bottom)
+		{
+			for (auto y = std::max(static_cast<unsigned int>(top), 1u); y < bottom && y + 1u < size.y; ++y)
+			{
+				const Word* above 	= open.getRow(y - 1u);
+				const Word* middle 	= open.getRow(y);
+				const Word* below 	= open.getRow(y + 1u);
+				Word* row = next.getRow(y);
+				for (auto word = 0u; word < words; ++word)
+				{
+					// Neighbour count of 64 tiles at once, as 4 bit planes
+					Word sum1, carry1, sum2, carry2, sum3, carry3;
+					addBits(getWest(above, word), above[word], getEast(above, word, words), sum1, carry1);
+					addBits(getWest(middle, word), getEast(middle, word, words), getWest(below, word), sum2, carry2);
+					addBits(below[word], getEast(below, word, words), 0u, sum3, carry3);
+
+					Word ones, carry4, twos, carry5;
+					addBits(sum1, sum2, sum3, ones, carry4);
+					addBits(carry1, carry2, carry3, twos, carry5);
+					Word fours = carry5 ^ (twos & carry4);
+					Word eights = carry5 & twos & carry4;
+					twos ^= carry4;
+
+					Word atLeastFive = eights | (fours & (twos | ones));
+					Word exactlyFour = fours & ~(eights | twos | ones);
+					row[word] = atLeastFive | (exactlyFour & middle[word]);
+				}
+				row[0] &= ~Word(1u);
+				row[words - 1u] &= lastWordMask;
+			}
+		});
+		std::swap(open, next);
+	}
+
+	// Only the caves reached from the rooms and tunnels are kept
+	BitGrid reached;
+	computeWalkability(level.tiles.data(), size, reached);
+	const BitGrid carved = reached;
+	for (auto y = 0u; y < size.y; ++y)
+	{
+		Word* row = open.getRow(y);
+		for (auto word = 0u; word < words; ++word)
+			row[word] |= carved.getRow(y)[word];
+		fillRow(reached.getRow(y), row, words);
+	}
+
+	// Rows are filled along, so only bits coming from the row above or below can spread further
+	for (auto changed = true; changed; )
+	{
+		changed = false;
+		for (auto pass = 0u; pass < 2u * size.y; ++pass)
+		{
+			auto down = pass < size.y;
+			auto y = down ? pass : 2u * size.y - 1u - pass;
+			auto from = down ? y - 1u : y + 1u;
+			if (from >= size.y)
+				continue;
+
+			Word* row = reached.getRow(y);
+			const Word* mask = open.getRow(y);
+			const Word* source = reached.getRow(from);
+			Word added = 0u;
+			for (auto word = 0u; word < words; ++word)
+			{
+				added |= source[word] & mask[word] & ~row[word];
+				row[word] |= source[word] & mask[word];
+			}
+			if (added != 0u)
+			{
+				fillRow(row, mask, words);
+				changed = true;
+			}
+		}
+	}
+
+	mThreads.parallelFor(size.y, [&] (std::size_t top, std::size_t bottom)
+	{
+		for (auto y = static_cast<unsigned int>(top); y < bottom; ++y)
+			for (auto word = 0u; word < words; ++word)
+			{
+				Word caves = reached.getRow(y)[word] & ~carved.getRow(y)[word];
+				while (caves != 0u)
+				{
+					auto index = word * BitGrid::WordBits + BitGrid::countTrailingZeros(caves) + y * size.x;
+					if (level.tiles[index] == Tile::Type::None)
+						level.tiles[index] = Tile::Type::Floor;
+					caves &= caves - 1u;
+				}
+			}
+	});
+}
+
+void DungeonGenerator::generateWalls(Level& level)
+{
+	const auto size = level.size;
+	// Sample walkability first, so bands can read the rows around them while walls are written
+	BitGrid walkable;
+	computeWalkability(level.tiles.data(), size, walkable);
+
+	const auto words = walkable.getWordsPerRow();
+	const auto lastWordMask = walkable.getLastWordMask();
+	mThreads.parallelFor(size.y, [&] (std::size_t top, std::size_t bottom)
+	{
+		// Walkable tiles or their left or right neighbour, within one row
+		auto spread = [&walkable, words] (unsigned int y, std::size_t word)
+		{
+			const BitGrid::Word* row = walkable.getRow(y);
+			BitGrid::Word left 	= (row[word] << 1) | (word > 0u ? row[word - 1u] >> (BitGrid::WordBits - 1u) : 0u);
+			BitGrid::Word right = (row[word] >> 1) | (word + 1u < words ? row[word + 1u] << (BitGrid::WordBits - 1u) : 0u);
+			return row[word] | left | right;
+		};
+
+		for (auto y = static_cast<unsigned int>(top); y < bottom; ++y)
+			for (auto word = 0u; word < words; ++word)
+			{
+				// Any walkable 8-neighbour, in 64 tiles at once
+				BitGrid::Word near = spread(y, word);
+				if (y > 0u)
+					near |= spread(y - 1u, word);
+				if (y + 1u < size.y)
+					near |= spread(y + 1u, word);
+
+				BitGrid::Word candidates = near & ~walkable.getRow(y)[word];
+				if (word + 1u == words)
+					candidates &= lastWordMask;
+
+				while (candidates != 0u)
+				{
+					auto index = word * BitGrid::WordBits + BitGrid::countTrailingZeros(candidates) + y * size.x;
+					if (level.tiles[index] == Tile::Type::None)
+						level.tiles[index] = Tile::Type::Wall;
+					candidates &= candidates - 1u;
+				}
+			}
+	});
+}
+
+void DungeonGenerator::computeWalkability(const Tile::Type* tiles, sf::Vector2u size, BitGrid& walkable)
+{
+	walkable.reset(size);
+	const auto words = walkable.getWordsPerRow();
+	mThreads.parallelFor(size.y, [tiles, size, words, &walkable] (std::size_t top, std::size_t bottom)
+	{
+		for (auto y = static_cast<unsigned int>(top); y < bottom; ++y)
+		{
+			BitGrid::Word* row = walkable.getRow(y);
+			const Tile::Type* rowTiles = tiles + y * size.x;
+			for (auto word = 0u; word < words; ++word)
+			{
+				auto first = word * BitGrid::WordBits;
+				auto count = std::min(BitGrid::WordBits, size.x - first);
+				BitGrid::Word bits = 0u;
+				for (auto bit = 0u; bit < count; ++bit)
+					bits |= BitGrid::Word(Tile::isWalkable(rowTiles[first + bit])) << bit;
+				row[word] = bits;
+			}
+		}
+	});
+}
@@ -0,0 +1,144 @@
+#include <Game/FieldOfView.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace
+{
+	// Maps the scanned octant (rows going up, columns going left) onto each of the 8 octants: xx, xy, yx, yy
+	const int Octants[8][4] =
+	{
+		{ 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+		{ -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 },
+	};
+}
+
+FieldOfView::FieldOfView(unsigned int radius)
+: mRadius(static_cast<int>(radius))
+, mOrigin()
+, mVisible()
+, mExplored()
+, mPrevious()
+, mVisibleTiles()
+, mPreviousTiles()
+{
+}
+
+void FieldOfView::reset(sf::Vector2u size)
+{
+	mVisible.reset(size);
+	mExplored.reset(size);
+	mPrevious.reset(size);
+	mVisibleTiles.clear();
+	mPreviousTiles.clear();
+}
+
+sf::Vector2u FieldOfView::getSize() const
+{
+	return mVisible.getSize();
+}
+
+void FieldOfView::compute(const BitGrid& walkable, Tile::ID origin, std::vector<Tile::ID>& changed)
+{
+	assert(walkable.getSize() == mVisible.getSize());
+	assert(origin.first < mVisible.getSize().x && origin.second < mVisible.getSize().y);
+
+	// The last result becomes the previous one, only tiles that differ between both are reported
+	std::swap(mVisible, mPrevious);
+	std::swap(mVisibleTiles, mPreviousTiles);
+	mVisibleTiles.clear();
+
+	mOrigin = origin;
+	reveal(origin.first, origin.second);
+	for (auto i = 0u; i < 8u; ++i)
+		castLight(walkable, 1, 1.f, 0.f, Octants[i]);
+
+	FOREACH(Tile::ID id, mVisibleTiles)
+		if (!mPrevious.get(id.first, id.second))
+			changed.push_back(id);
+
+	FOREACH(Tile::ID id, mPreviousTiles)
+	{
+		if (!mVisible.get(id.first, id.second))
+			changed.push_back(id);
+		mPrevious.set(id.first, id.second, false);
+	}
+}
+
+bool FieldOfView::isVisible(Tile::ID id) const
+{
+	return mVisible.get(id.first, id.second);
+}
+
+bool FieldOfView::isExplored(Tile::ID id) const
+{
+	return mExplored.get(id.first, id.second);
+}
+
+void FieldOfView::castLight(const BitGrid& walkable, int row, float start, float end, const int (&transform)[4])
+{
+	// Scans rows of growing distance between the start and end slopes; a run of walls splits the
+	// light in two, the part before it is scanned recursively, the part after continues here
+	if (start < end)
+		return;
+
+	const auto size = walkable.getSize();
+	float newStart = 0.f;
+	for (auto distance = row; distance <= mRadius; ++distance)
+	{
+		bool blocked = false;
+		const int dy = -distance;
+		for (auto dx = -distance; dx <= 0; ++dx)
+		{
+			float leftSlope 	= (dx - 0.5f) / (dy + 0.5f);
+			float rightSlope 	= (dx + 0.5f) / (dy - 0.5f);
+			if (start < rightSlope)
+				continue;
+			if (end > leftSlope)
+				break;
+
+			// Unsigned coordinates wrap around when leaving the left or top border
+			auto x = static_cast<unsigned int>(static_cast<int>(mOrigin.first) + dx * transform[0] + dy * transform[1]);
+			auto y = static_cast<unsigned int>(static_cast<int>(mOrigin.second) + dx * transform[2] + dy * transform[3]);
+			bool inside = x < size.x && y < size.y;
+			if (inside && dx * dx + dy * dy <= mRadius * mRadius)
+				reveal(x, y);
+
+			bool opaque = !inside || !walkable.get(x, y);
+			if (blocked)
+			{
+				if (opaque)
+				{
+					newStart = rightSlope;
+				}
+				else
+				{
+					blocked = false;
+					start = newStart;
+				}
+			}
+			else if (opaque && distance < mRadius)
+			{
+				blocked = true;
+				castLight(walkable, distance + 1, start, leftSlope, transform);
+				newStart = rightSlope;
+			}
+		}
+
+		if (blocked)
+			break;
+	}
+}
+
+void FieldOfView::reveal(int x, int y)
+{
+	// Octants share their border lines, tiles on them are reached twice
+	if (mVisible.get(x, y))
+		return;
+
+	mVisible.set(x, y, true);
+	mExplored.set(x, y, true);
+	mVisibleTiles.push_back(Tile::ID(x, y));
+}
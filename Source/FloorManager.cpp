@@ -0,0 +1,125 @@
+#include <Game/FloorManager.hpp>
+#include <Game/Foreach.hpp>
+#include <Game/Utility.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <random>
+
+
+namespace
+{
+	const sf::Color TorchColor(255, 140, 40);
+	const unsigned int TorchRadius = 5u;
+
+	// Layouts take turns with depth
+	const DungeonGenerator::Layout Layouts[] =
+	{
+		DungeonGenerator::Rooms,
+		DungeonGenerator::Caves,
+		DungeonGenerator::Partitions,
+	};
+}
+
+FloorManager::FloorManager(const TextureHolder& textures, ThreadPool& threads, unsigned int seed)
+: mTextures(textures)
+, mThreads(threads)
+, mBackgroundThreads(1u)
+, mSeed(seed)
+, mDepth(0u)
+, mNext()
+{
+}
+
+bool FloorManager::isNextReady() const
+{
+	return mNext.valid() && mNext.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+FloorManager::Floor FloorManager::nextFloor()
+{
+	// Nothing to show yet for the first floor, it is built right away with every worker
+	Floor floor = mNext.valid() ? mNext.get() : build(mDepth++, mThreads);
+	floor.tilemap->setThreadPool(mThreads);
+	mNext = std::async(std::launch::async, &FloorManager::build, this, mDepth++, std::ref(mBackgroundThreads));
+	return floor;
+}
+
+FloorManager::Floor FloorManager::build(unsigned int depth, ThreadPool& threads) const
+{
+	// Every floor has its own seed, the same dungeon seed gives the same floors
+	std::default_random_engine random(mSeed + depth);
+
+	Floor floor;
+	floor.depth = depth;
+	floor.tilemap.reset(new Tilemap(mTextures, threads, mSeed + depth, Layouts[depth % 3u]));
+	Tilemap& tilemap = *floor.tilemap;
+	floor.playerSpawn = tilemap.getRandomSpawnPoint(random);
+
+	// Stairs in the furthest room that can be reached from the spawn
+	const std::vector<sf::IntRect>& rooms = tilemap.getRooms();
+	const RoomGraph& graph = tilemap.getRoomGraph();
+	auto spawnTile = tilemap.getTileID(floor.playerSpawn);
+	auto spawnRoom = tilemap.getRoomIndex(spawnTile);
+	auto stairsRoom = spawnRoom;
+	auto furthest = 0;
+	for (std::size_t i = 0u; i < rooms.size(); ++i)
+	{
+		auto offset = getCenter(rooms[i]) - sf::Vector2i(spawnTile.first, spawnTile.second);
+		auto distance = offset.x * offset.x + offset.y * offset.y;
+		if (distance > furthest && graph.isConnected(spawnRoom, static_cast<Level::RoomIndex>(i)))
+		{
+			furthest = distance;
+			stairsRoom = static_cast<Level::RoomIndex>(i);
+		}
+	}
+	// Next to the torch, or the walkable tile closest to it; rooms may keep walls along the map edge and caves are eroded
+	auto target = getCenter(rooms[stairsRoom]) + sf::Vector2i(1, 0);
+	auto closest = std::numeric_limits<int>::max();
+	FOREACH(Tile::ID id, TileRange(rooms[stairsRoom]))
+	{
+		auto offset = sf::Vector2i(id.first, id.second) - target;
+		auto distance = offset.x * offset.x + offset.y * offset.y;
+		if (distance < closest && tilemap.isWalkable(id))
+		{
+			closest = distance;
+			floor.stairs = id;
+		}
+	}
+	assert(tilemap.isWalkable(floor.stairs));
+	tilemap.setTileType(floor.stairs, Tile::Stairs);
+
+	// One torch in the middle of every room
+	FOREACH(const sf::IntRect& room, rooms)
+	{
+		auto center = getCenter(room);
+		tilemap.addLight(Tile::ID(center.x, center.y), TorchColor, TorchRadius);
+	}
+
+	auto roomRandomFactor = 2;
+	// TODO: max number of enemies to spawn, better distribution
+	// Tiles to step over before the next candidate, carried from room to room
+	auto skip = 0;
+	FOREACH(const sf::IntRect& room, rooms)
+	{
+		FOREACH(Tile::ID id, TileRange(room))
+		{
+			if (skip-- > 0)
+				continue;
+
+			// chance % of spawning enemy; TODO: create function!
+			auto chance = 0.05f;
+			if ((randomInt(101, random)) / 100.f >= 1.f - chance)
+			{
+				auto bounds = tilemap.getTileBounds(id);
+				floor.enemySpawns.push_back(sf::Vector2f(bounds.left, bounds.top));
+			}
+			skip = randomInt(roomRandomFactor, random);
+		}
+	}
+
+	return floor;
+}
@@ -0,0 +1,140 @@
+#include <Game/FlowField.hpp>
+#include <Game/Tilemap.hpp>
+#include <Game/Foreach.hpp>
+#include <Game/Utility.hpp>
+
+#include <cassert>
+
+
+const sf::Uint16 FlowField::Unreachable = 0xFFFF;
+
+namespace
+{
+	const int Offsets[8][2] =
+	{
+		{ -1,  0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+		{ -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 },
+	};
+
+	// Diagonal steps may not cut wall corners
+	bool canStep(const Tilemap& tilemap, Tile::ID from, int dx, int dy)
+	{
+		Tile::ID to(from.first + dx, from.second + dy);
+		if (!tilemap.validateTile(to) || !tilemap.isWalkable(to))
+			return false;
+
+		return dx == 0 || dy == 0
+			|| (tilemap.isWalkable(Tile::ID(from.first + dx, from.second)) && tilemap.isWalkable(Tile::ID(from.first, from.second + dy)));
+	}
+}
+
+FlowField::FlowField(unsigned int range)
+: mRange(range)
+, mTarget()
+, mRevision(0u)
+, mSize()
+, mDistances()
+, mVisited()
+{
+	assert(range < Unreachable);
+}
+
+bool FlowField::update(const Tilemap& tilemap, Tile::ID target)
+{
+	if (tilemap.getSize() != mSize)
+	{
+		mSize = tilemap.getSize();
+		mDistances.assign(mSize.x * mSize.y, Unreachable);
+		mVisited.clear();
+	}
+	else if (target == mTarget && tilemap.getRevision() == mRevision && !mVisited.empty())
+	{
+		return false;
+	}
+
+	mTarget = target;
+	mRevision = tilemap.getRevision();
+	FOREACH(Tile::ID id, mVisited)
+		mDistances[getIndex(id)] = Unreachable;
+	mVisited.clear();
+
+	if (!tilemap.validateTile(target) || !tilemap.isWalkable(target))
+		return true;
+
+	// Breadth-first, every step costs the same; mVisited doubles as the queue
+	mDistances[getIndex(target)] = 0u;
+	mVisited.push_back(target);
+	for (std::size_t next = 0u; next < mVisited.size(); ++next)
+	{
+		Tile::ID id = mVisited[next];
+		auto distance = mDistances[getIndex(id)];
+		if (distance >= mRange)
+			continue;
+
+		for (auto i = 0u; i < 8u; ++i)
+		{
+			if (!canStep(tilemap, id, Offsets[i][0], Offsets[i][1]))
+				continue;
+
+			Tile::ID neighbour(id.first + Offsets[i][0], id.second + Offsets[i][1]);
+			sf::Uint16& neighbourDistance = mDistances[getIndex(neighbour)];
+			if (neighbourDistance == Unreachable)
+			{
+				neighbourDistance = distance + 1u;
+				mVisited.push_back(neighbour);
+			}
+		}
+	}
+	return true;
+}
+
+void FlowField::clear()
+{
+	// The next update recomputes, whatever the target and revision
+	FOREACH(Tile::ID id, mVisited)
+		mDistances[getIndex(id)] = Unreachable;
+	mVisited.clear();
+}
+
+sf::Uint16 FlowField::getDistance(Tile::ID id) const
+{
+	if (id.first >= mSize.x || id.second >= mSize.y)
+		return Unreachable;
+
+	return mDistances[getIndex(id)];
+}
+
+sf::Vector2f FlowField::getDirection(const Tilemap& tilemap, sf::Vector2f position) const
+{
+	Tile::ID id = tilemap.getTileID(position);
+	auto distance = getDistance(id);
+	if (distance == Unreachable)
+		return sf::Vector2f();
+
+	// Head for the center of the best neighbour, or of the target tile once on it
+	Tile::ID best = id;
+	for (auto i = 0u; i < 8u; ++i)
+	{
+		if (!canStep(tilemap, id, Offsets[i][0], Offsets[i][1]))
+			continue;
+
+		Tile::ID neighbour(id.first + Offsets[i][0], id.second + Offsets[i][1]);
+		if (getDistance(neighbour) < distance)
+		{
+			best = neighbour;
+			distance = getDistance(neighbour);
+		}
+	}
+
+	auto bounds = tilemap.getTileBounds(best);
+	sf::Vector2f offset(bounds.left + bounds.width / 2.f - position.x, bounds.top + bounds.height / 2.f - position.y);
+	if (offset.x == 0.f && offset.y == 0.f)
+		return offset;
+
+	return unitVector(offset);
+}
+
+std::size_t FlowField::getIndex(Tile::ID id) const
+{
+	return id.first + id.second * mSize.x;
+}
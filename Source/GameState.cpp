@@ -1,12 +1,13 @@
 #include <Game/GameState.hpp>
 #include <Game/MusicPlayer.hpp>
+#include <Game/Utility.hpp>
 
 #include <SFML/Graphics/RenderWindow.hpp>
 
 
 GameState::GameState(StateStack& stack, Context context)
 : State(stack, context)
-, mDungeon(*context.window, *context.fonts, *context.sounds)
+, mDungeon(*context.window, *context.fonts, *context.sounds, *context.threads, randomSeed())
 , mPlayer(*context.player)
 {
 }
@@ -0,0 +1,57 @@
+#include <Game/Level.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+const Level::RoomIndex Level::NoRoom = 0xFFFF;
+const std::size_t Level::MaxRooms = Level::NoRoom;
+
+Level::Level()
+: seed(0u)
+, size()
+, tiles()
+, rooms()
+, roomIndices()
+, tunnels()
+, spawns()
+{
+}
+
+void Level::addRoom(sf::IntRect room)
+{
+	assert(rooms.size() < MaxRooms);
+	auto index = static_cast<RoomIndex>(rooms.size());
+	rooms.push_back(room);
+
+	for (auto y = room.top; y < room.top + room.height; ++y)
+		std::fill_n(roomIndices.begin() + room.left + y * size.x, room.width, index);
+}
+
+void Level::indexRooms()
+{
+	std::vector<sf::IntRect> indexed;
+	indexed.swap(rooms);
+	roomIndices.assign(size.x * size.y, NoRoom);
+
+	for (auto i = 0u; i < indexed.size(); ++i)
+		addRoom(indexed[i]);
+}
+
+Level::RoomIndex Level::getRoomIndex(unsigned int x, unsigned int y) const
+{
+	assert(x < size.x && y < size.y);
+	return roomIndices[x + y * size.x];
+}
+
+bool Level::isFree(sf::IntRect area) const
+{
+	// Rooms never overlap, so the tiles under area tell which rooms it would intersect
+	for (auto y = area.top; y < area.top + area.height; ++y)
+	{
+		auto row = roomIndices.begin() + area.left + y * size.x;
+		if (std::find_if(row, row + area.width, [] (RoomIndex index) { return index != NoRoom; }) != row + area.width)
+			return false;
+	}
+	return true;
+}
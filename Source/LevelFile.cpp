@@ -0,0 +1,207 @@
+#include <Game/LevelFile.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+const sf::Uint32 LevelFile::Version = 1u;
+
+namespace
+{
+	const char Magic[4] = { 'D', 'L', 'V', 'L' };
+
+	template <typename T>
+	void write(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+}
+
+LevelFile::LevelFile()
+: mData(nullptr)
+, mSize(0u)
+, mTiles(nullptr)
+{
+}
+
+LevelFile::~LevelFile()
+{
+	close();
+}
+
+void LevelFile::save(const Level& level, const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("LevelFile::save - Failed to open " + filename);
+
+	Header header;
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version 		= Version;
+	header.seed 		= level.seed;
+	header.width 		= level.size.x;
+	header.height 		= level.size.y;
+	header.roomCount 	= static_cast<sf::Uint32>(level.rooms.size());
+	header.tunnelCount 	= static_cast<sf::Uint32>(level.tunnels.size());
+	header.spawnCount 	= static_cast<sf::Uint32>(level.spawns.size());
+	write(file, header);
+
+	FOREACH(const sf::IntRect& room, level.rooms)
+	{
+		Room entry = { room.left, room.top, room.width, room.height };
+		write(file, entry);
+	}
+	FOREACH(const sf::IntRect& tunnel, level.tunnels)
+	{
+		Room entry = { tunnel.left, tunnel.top, tunnel.width, tunnel.height };
+		write(file, entry);
+	}
+	FOREACH(const sf::Vector2u& spawn, level.spawns)
+	{
+		Spawn entry = { spawn.x, spawn.y };
+		write(file, entry);
+	}
+	file.write(reinterpret_cast<const char*>(level.tiles.data()), level.tiles.size() * sizeof(Tile::Type));
+
+	if (!file)
+		throw std::runtime_error("LevelFile::save - Failed to write " + filename);
+}
+
+void LevelFile::load(const std::string& filename, Level& level)
+{
+	close();
+
+	// Private mapping: pages are read on first access and copied on first write
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("LevelFile::load - Failed to open " + filename);
+
+	LARGE_INTEGER size;
+	HANDLE mapping = GetFileSizeEx(file, &size) ? CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+	CloseHandle(file);
+	if (!mapping)
+		throw std::runtime_error("LevelFile::load - Failed to map " + filename);
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data)
+		throw std::runtime_error("LevelFile::load - Failed to map " + filename);
+
+	mData = static_cast<char*>(data);
+	mSize = static_cast<std::size_t>(size.QuadPart);
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("LevelFile::load - Failed to open " + filename);
+
+	struct stat status;
+	void* data = MAP_FAILED;
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+		data = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("LevelFile::load - Failed to map " + filename);
+
+	mData = static_cast<char*>(data);
+	mSize = static_cast<std::size_t>(status.st_size);
+#endif
+
+	// Validate the header and the section sizes against the file size before touching anything else
+	const Header* header = reinterpret_cast<const Header*>(mData);
+	if (mSize < sizeof(Header) || std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != Version)
+	{
+		close();
+		throw std::runtime_error("LevelFile::load - Unsupported level file " + filename);
+	}
+
+	const std::size_t roomsSize = (static_cast<std::size_t>(header->roomCount) + header->tunnelCount) * sizeof(Room);
+	const std::size_t spawnsSize = static_cast<std::size_t>(header->spawnCount) * sizeof(Spawn);
+	const std::size_t tilesSize = static_cast<std::size_t>(header->width) * header->height * sizeof(Tile::Type);
+	if (mSize != sizeof(Header) + roomsSize + spawnsSize + tilesSize)
+	{
+		close();
+		throw std::runtime_error("LevelFile::load - Truncated level file " + filename);
+	}
+
+	// Rooms get indexed and spawns are used as tile positions, nothing may point outside the map.
+	// A spawn is always picked, so there has to be one
+	const Room* rooms = reinterpret_cast<const Room*>(mData + sizeof(Header));
+	const Spawn* spawns = reinterpret_cast<const Spawn*>(mData + sizeof(Header) + roomsSize);
+	auto isInside = [header] (const Room& rect)
+	{
+		return rect.left >= 0 && rect.top >= 0 && rect.width >= 0 && rect.height >= 0
+			&& static_cast<sf::Uint64>(rect.left) + rect.width <= header->width
+			&& static_cast<sf::Uint64>(rect.top) + rect.height <= header->height;
+	};
+	auto isOnMap = [header] (const Spawn& spawn)
+	{
+		return spawn.x < header->width && spawn.y < header->height;
+	};
+	// Tile bytes index the tileset tables; every page is read for the walkable tiles right after anyway
+	const sf::Uint8* tiles = reinterpret_cast<const sf::Uint8*>(mData + sizeof(Header) + roomsSize + spawnsSize);
+	auto isUnknown = [] (sf::Uint8 type)
+	{
+		return type >= Tile::TypeCount;
+	};
+	if (header->roomCount > Level::MaxRooms || header->spawnCount == 0u
+		|| !std::all_of(rooms, rooms + header->roomCount + header->tunnelCount, isInside)
+		|| !std::all_of(spawns, spawns + header->spawnCount, isOnMap)
+		|| std::any_of(tiles, tiles + tilesSize, isUnknown))
+	{
+		close();
+		throw std::runtime_error("LevelFile::load - Corrupt level file " + filename);
+	}
+
+	level.seed = header->seed;
+	level.size = sf::Vector2u(header->width, header->height);
+	level.tiles.clear();
+
+	level.rooms.clear();
+	for (auto i = 0u; i < header->roomCount; ++i, ++rooms)
+		level.rooms.push_back(sf::IntRect(rooms->left, rooms->top, rooms->width, rooms->height));
+
+	level.tunnels.clear();
+	for (auto i = 0u; i < header->tunnelCount; ++i, ++rooms)
+		level.tunnels.push_back(sf::IntRect(rooms->left, rooms->top, rooms->width, rooms->height));
+
+	level.indexRooms();
+
+	level.spawns.clear();
+	for (auto i = 0u; i < header->spawnCount; ++i, ++spawns)
+		level.spawns.push_back(sf::Vector2u(spawns->x, spawns->y));
+
+	mTiles = reinterpret_cast<Tile::Type*>(mData + sizeof(Header) + roomsSize + spawnsSize);
+}
+
+void LevelFile::close()
+{
+	if (!mData)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mData);
+#else
+	munmap(mData, mSize);
+#endif
+	mData = nullptr;
+	mSize = 0u;
+	mTiles = nullptr;
+}
+
+Tile::Type* LevelFile::getTiles()
+{
+	return mTiles;
+}
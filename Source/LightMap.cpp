@@ -0,0 +1,172 @@
+#include <Game/LightMap.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+
+namespace
+{
+	const int Offsets[8][2] =
+	{
+		{ -1,  0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+		{ -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 },
+	};
+
+	sf::Uint8 addClamped(sf::Uint8 ambient, sf::Uint16 level)
+	{
+		return static_cast<sf::Uint8>(std::min(255, ambient + level));
+	}
+}
+
+LightMap::LightMap()
+: mSize()
+, mLights()
+, mLevels()
+, mVisited()
+{
+}
+
+void LightMap::rebuild(const BitGrid& walkable)
+{
+	mSize = walkable.getSize();
+	mLevels.assign(mSize.x * mSize.y * 3, 0u);
+	mVisited.reset(mSize);
+
+	FOREACH(Light& light, mLights)
+	{
+		if (!light.active)
+			continue;
+
+		spread(walkable, light);
+		apply(light, 1, nullptr);
+	}
+}
+
+LightMap::LightID LightMap::addLight(const BitGrid& walkable, Tile::ID position, sf::Color color, unsigned int radius, std::vector<Tile::ID>& changed)
+{
+	// Slots of removed lights are reused
+	auto found = std::find_if(mLights.begin(), mLights.end(), [] (const Light& light) { return !light.active; });
+	LightID id = found - mLights.begin();
+	if (found == mLights.end())
+		mLights.push_back(Light());
+
+	Light& light = mLights[id];
+	light.position = position;
+	light.color = color;
+	light.radius = radius;
+	light.active = true;
+	spread(walkable, light);
+	apply(light, 1, &changed);
+	return id;
+}
+
+void LightMap::moveLight(const BitGrid& walkable, LightID id, Tile::ID position, std::vector<Tile::ID>& changed)
+{
+	assert(id < mLights.size() && mLights[id].active);
+	Light& light = mLights[id];
+	if (light.position == position)
+		return;
+
+	// Only the tiles lit before or after the move change
+	apply(light, -1, &changed);
+	light.position = position;
+	spread(walkable, light);
+	apply(light, 1, &changed);
+}
+
+void LightMap::removeLight(LightID id, std::vector<Tile::ID>& changed)
+{
+	assert(id < mLights.size() && mLights[id].active);
+	Light& light = mLights[id];
+	apply(light, -1, &changed);
+	light.active = false;
+	light.tiles.clear();
+}
+
+void LightMap::updateTile(const BitGrid& walkable, Tile::ID id, std::vector<Tile::ID>& changed)
+{
+	FOREACH(Light& light, mLights)
+	{
+		int dx = static_cast<int>(id.first) - static_cast<int>(light.position.first);
+		int dy = static_cast<int>(id.second) - static_cast<int>(light.position.second);
+		// One tile of margin, a wall at the edge of the light may have opened a way further
+		if (!light.active || std::abs(dx) > static_cast<int>(light.radius) + 1 || std::abs(dy) > static_cast<int>(light.radius) + 1)
+			continue;
+
+		apply(light, -1, &changed);
+		spread(walkable, light);
+		apply(light, 1, &changed);
+	}
+}
+
+sf::Color LightMap::getColor(Tile::ID id, sf::Color ambient) const
+{
+	const sf::Uint16* level = &mLevels[(id.first + id.second * mSize.x) * 3];
+	return sf::Color(addClamped(ambient.r, level[0]), addClamped(ambient.g, level[1]), addClamped(ambient.b, level[2]), ambient.a);
+}
+
+void LightMap::spread(const BitGrid& walkable, Light& light)
+{
+	light.tiles.clear();
+
+	// Unsigned IDs wrap around when stepping off the left or top border
+	const Tile::ID origin = light.position;
+	if (origin.first >= mSize.x || origin.second >= mSize.y)
+		return;
+
+	// Breadth-first, one ring of steps at a time; the tile list doubles as the queue
+	const int radius = static_cast<int>(light.radius);
+	mVisited.set(origin.first, origin.second, true);
+	light.tiles.push_back(std::make_pair(origin.first + origin.second * mSize.x, sf::Uint8(255)));
+	std::size_t begin = 0u;
+	for (auto distance = 1; distance <= radius && begin < light.tiles.size(); ++distance)
+	{
+		auto level = static_cast<sf::Uint8>(255 * (radius + 1 - distance) / (radius + 1));
+		auto end = light.tiles.size();
+		for (auto i = begin; i < end; ++i)
+		{
+			auto x = static_cast<unsigned int>(light.tiles[i].first % mSize.x);
+			auto y = static_cast<unsigned int>(light.tiles[i].first / mSize.x);
+			if (!walkable.get(x, y))
+				continue;
+
+			for (auto j = 0u; j < 8u; ++j)
+			{
+				unsigned int nx = x + Offsets[j][0];
+				unsigned int ny = y + Offsets[j][1];
+				int dx = static_cast<int>(nx) - static_cast<int>(origin.first);
+				int dy = static_cast<int>(ny) - static_cast<int>(origin.second);
+				if (nx >= mSize.x || ny >= mSize.y || mVisited.get(nx, ny) || dx * dx + dy * dy > radius * radius)
+					continue;
+
+				// Like movement, light does not slip between two diagonal walls
+				if (Offsets[j][0] != 0 && Offsets[j][1] != 0 && (!walkable.get(nx, y) || !walkable.get(x, ny)))
+					continue;
+
+				mVisited.set(nx, ny, true);
+				light.tiles.push_back(std::make_pair(nx + ny * mSize.x, level));
+			}
+		}
+		begin = end;
+	}
+
+	FOREACH(auto& tile, light.tiles)
+		mVisited.set(static_cast<unsigned int>(tile.first % mSize.x), static_cast<unsigned int>(tile.first / mSize.x), false);
+}
+
+void LightMap::apply(const Light& light, int sign, std::vector<Tile::ID>* changed)
+{
+	// Integer sums, so removing a light restores exactly what was there before
+	const int color[3] = { light.color.r, light.color.g, light.color.b };
+	FOREACH(auto& tile, light.tiles)
+	{
+		sf::Uint16* level = &mLevels[tile.first * 3];
+		for (auto i = 0u; i < 3u; ++i)
+			level[i] = static_cast<sf::Uint16>(level[i] + sign * (color[i] * tile.second / 255));
+
+		if (changed)
+			changed->push_back(Tile::ID(static_cast<unsigned int>(tile.first % mSize.x), static_cast<unsigned int>(tile.first / mSize.x)));
+	}
+}
@@ -0,0 +1,390 @@
+#include <Game/Pathfinder.hpp>
+#include <Game/Utility.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+
+
+namespace
+{
+	const std::size_t PathCacheSize = 4096u;
+
+	// Octile distance, diagonal steps cost sqrt(2)
+	float getDistance(int x1, int y1, int x2, int y2)
+	{
+		float dx = static_cast<float>(std::abs(x2 - x1));
+		float dy = static_cast<float>(std::abs(y2 - y1));
+		return std::max(dx, dy) + (std::sqrt(2.f) - 1.f) * std::min(dx, dy);
+	}
+
+	int getSign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+}
+
+Pathfinder::Pathfinder(const Level& level, const BitGrid& walkable)
+: mLevel(level)
+, mWalkable(walkable)
+, mRows(nullptr)
+, mWordsPerRow(0u)
+, mWidth(0)
+, mHeight(0)
+, mColumns()
+, mColumnsValid(false)
+, mGoal()
+, mSearch(0u)
+, mStamps()
+, mCosts()
+, mParents()
+, mOpenList()
+, mCache()
+, mCacheLookup()
+, mOpenRooms()
+{
+}
+
+bool Pathfinder::findPath(Tile::ID start, Tile::ID goal, Path& path)
+{
+	path.clear();
+	bindGrid();
+	auto startRoom 	= start.first < mLevel.size.x && start.second < mLevel.size.y ? mLevel.getRoomIndex(start.first, start.second) : Level::NoRoom;
+	auto goalRoom 	= goal.first < mLevel.size.x && goal.second < mLevel.size.y ? mLevel.getRoomIndex(goal.first, goal.second) : Level::NoRoom;
+
+	// Within a fully walkable room any two tiles see each other
+	if (startRoom == Level::NoRoom || goalRoom == Level::NoRoom || !isOpenRoom(startRoom) || !isOpenRoom(goalRoom))
+		return search(start, goal, path);
+
+	if (startRoom == goalRoom)
+	{
+		if (start != goal)
+			path.push_back(goal);
+		return true;
+	}
+
+	const Path& between = getRoomPath(startRoom, goalRoom);
+	if (between.empty())
+		return false;
+
+	auto startCenter = getCenter(mLevel.rooms[startRoom]);
+	if (start != Tile::ID(startCenter.x, startCenter.y))
+		path.push_back(Tile::ID(startCenter.x, startCenter.y));
+	path.insert(path.end(), between.begin(), between.end());
+	if (goal != between.back())
+		path.push_back(goal);
+	return true;
+}
+
+bool Pathfinder::search(Tile::ID start, Tile::ID goal, Path& path)
+{
+	path.clear();
+	bindGrid();
+	if (!isWalkable(start.first, start.second) || !isWalkable(goal.first, goal.second))
+		return false;
+
+	const std::size_t tileCount = mLevel.size.x * mLevel.size.y;
+	if (mStamps.size() != tileCount)
+	{
+		mStamps.assign(tileCount, 0u);
+		mCosts.resize(tileCount);
+		mParents.resize(tileCount);
+		mSearch = 0u;
+	}
+
+	// Stamps: 2 * search when opened, 2 * search + 1 once closed; restart from scratch on overflow
+	if (++mSearch >= 0x7FFFFFFFu)
+	{
+		std::fill(mStamps.begin(), mStamps.end(), 0u);
+		mSearch = 1u;
+	}
+	const sf::Uint32 opened = 2u * mSearch;
+	const sf::Uint32 closed = opened + 1u;
+
+	mGoal = goal;
+	mOpenList.clear();
+	sf::Uint32 startIndex = start.first + start.second * mLevel.size.x;
+	sf::Uint32 goalIndex = goal.first + goal.second * mLevel.size.x;
+	mStamps[startIndex] = opened;
+	mCosts[startIndex] = 0.f;
+	mParents[startIndex] = startIndex;
+	mOpenList.push_back(std::make_pair(getDistance(start.first, start.second, goal.first, goal.second), startIndex));
+
+	while (!mOpenList.empty())
+	{
+		std::pop_heap(mOpenList.begin(), mOpenList.end(), std::greater<std::pair<float, sf::Uint32>>());
+		sf::Uint32 index = mOpenList.back().second;
+		mOpenList.pop_back();
+
+		// Stale entry of a node already reached through a cheaper one
+		if (mStamps[index] == closed)
+			continue;
+		mStamps[index] = closed;
+
+		if (index == goalIndex)
+		{
+			for (; index != startIndex; index = mParents[index])
+				path.push_back(Tile::ID(index % mLevel.size.x, index / mLevel.size.x));
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		int x = index % mLevel.size.x;
+		int y = index / mLevel.size.x;
+		if (index == startIndex)
+		{
+			for (auto dx = -1; dx <= 1; ++dx)
+				for (auto dy = -1; dy <= 1; ++dy)
+					if ((dx != 0 || dy != 0) && isWalkable(x + dx, y + dy) && isWalkable(x + dx, y) && isWalkable(x, y + dy))
+						addJumpPoint(index, dx, dy);
+			continue;
+		}
+
+		// Pruned neighbours, depending on the direction we came from
+		int dx = getSign(x - static_cast<int>(mParents[index] % mLevel.size.x));
+		int dy = getSign(y - static_cast<int>(mParents[index] / mLevel.size.x));
+		if (dx != 0 && dy != 0)
+		{
+			bool horizontal = isWalkable(x + dx, y);
+			bool vertical 	= isWalkable(x, y + dy);
+			if (vertical)
+				addJumpPoint(index, 0, dy);
+			if (horizontal)
+				addJumpPoint(index, dx, 0);
+			if (horizontal && vertical)
+				addJumpPoint(index, dx, dy);
+		}
+		else if (dx != 0)
+		{
+			bool next 	= isWalkable(x + dx, y);
+			bool up 	= isWalkable(x, y - 1);
+			bool down 	= isWalkable(x, y + 1);
+			if (next)
+			{
+				addJumpPoint(index, dx, 0);
+				if (up && isWalkable(x + dx, y - 1))
+					addJumpPoint(index, dx, -1);
+				if (down && isWalkable(x + dx, y + 1))
+					addJumpPoint(index, dx, 1);
+			}
+			if (up)
+				addJumpPoint(index, 0, -1);
+			if (down)
+				addJumpPoint(index, 0, 1);
+		}
+		else
+		{
+			bool next 	= isWalkable(x, y + dy);
+			bool left 	= isWalkable(x - 1, y);
+			bool right 	= isWalkable(x + 1, y);
+			if (next)
+			{
+				addJumpPoint(index, 0, dy);
+				if (left && isWalkable(x - 1, y + dy))
+					addJumpPoint(index, -1, dy);
+				if (right && isWalkable(x + 1, y + dy))
+					addJumpPoint(index, 1, dy);
+			}
+			if (left)
+				addJumpPoint(index, -1, 0);
+			if (right)
+				addJumpPoint(index, 1, 0);
+		}
+	}
+	return false;
+}
+
+void Pathfinder::clearCache()
+{
+	mCache.clear();
+	mCacheLookup.clear();
+	mOpenRooms.clear();
+	mColumnsValid = false;
+}
+
+void Pathfinder::bindGrid()
+{
+	// Walkability is read straight from the words, jumps test it many times per tile
+	assert(mWalkable.getSize() == mLevel.size);
+	mRows = mLevel.size.y > 0u ? mWalkable.getRow(0u) : nullptr;
+	mWordsPerRow = mWalkable.getWordsPerRow();
+	mWidth = static_cast<int>(mLevel.size.x);
+	mHeight = static_cast<int>(mLevel.size.y);
+
+	if (!mColumnsValid || mColumns.getSize() != sf::Vector2u(mLevel.size.y, mLevel.size.x))
+	{
+		mColumns.reset(sf::Vector2u(mLevel.size.y, mLevel.size.x));
+		for (auto y = 0u; y < mLevel.size.y; ++y)
+			for (auto word = 0u; word < mWordsPerRow; ++word)
+				for (BitGrid::Word bits = mWalkable.getRow(y)[word]; bits != 0u; bits &= bits - 1u)
+					mColumns.set(y, word * BitGrid::WordBits + BitGrid::countTrailingZeros(bits), true);
+		mColumnsValid = true;
+	}
+}
+
+bool Pathfinder::isWalkable(int x, int y) const
+{
+	return x >= 0 && y >= 0 && x < mWidth && y < mHeight
+		&& ((mRows[y * mWordsPerRow + x / BitGrid::WordBits] >> (x % BitGrid::WordBits)) & 1u);
+}
+
+bool Pathfinder::isOpenRoom(Level::RoomIndex room)
+{
+	// -1 until checked
+	if (mOpenRooms.size() != mLevel.rooms.size())
+		mOpenRooms.assign(mLevel.rooms.size(), -1);
+
+	if (mOpenRooms[room] < 0)
+	{
+		const sf::IntRect& bounds = mLevel.rooms[room];
+		mOpenRooms[room] = 1;
+		for (auto y = bounds.top; y < bounds.top + bounds.height; ++y)
+			for (auto x = bounds.left; x < bounds.left + bounds.width; ++x)
+				if (!isWalkable(x, y))
+					mOpenRooms[room] = 0;
+	}
+	return mOpenRooms[room] == 1;
+}
+
+const Pathfinder::Path& Pathfinder::getRoomPath(Level::RoomIndex from, Level::RoomIndex to)
+{
+	RoomPair key(from, to);
+	auto found = mCacheLookup.find(key);
+	if (found != mCacheLookup.end())
+	{
+		mCache.splice(mCache.begin(), mCache, found->second);
+		return found->second->second;
+	}
+
+	// An empty path marks unreachable rooms
+	auto fromCenter = getCenter(mLevel.rooms[from]);
+	auto toCenter = getCenter(mLevel.rooms[to]);
+	mCache.push_front(std::make_pair(key, Path()));
+	search(Tile::ID(fromCenter.x, fromCenter.y), Tile::ID(toCenter.x, toCenter.y), mCache.front().second);
+	mCacheLookup.insert(std::make_pair(key, mCache.begin()));
+
+	if (mCache.size() > PathCacheSize)
+	{
+		mCacheLookup.erase(mCache.back().first);
+		mCache.pop_back();
+	}
+	return mCache.front().second;
+}
+
+bool Pathfinder::jumpStraight(int& x, int& y, int dx, int dy) const
+{
+	if (dx != 0)
+		return scanLine(mWalkable, x, y, dx, mGoal.first, mGoal.second);
+	else
+		return scanLine(mColumns, y, x, dy, mGoal.second, mGoal.first);
+}
+
+bool Pathfinder::scanLine(const BitGrid& grid, int& x, int y, int dx, int goalX, int goalY) const
+{
+	// Tests a whole word of tiles at once. A tile stops the jump if it is blocked,
+	// the goal, or if a wall beside the previous tile ends there
+	const int wordBits = static_cast<int>(BitGrid::WordBits);
+	const int words = static_cast<int>(grid.getWordsPerRow());
+	const int lines = static_cast<int>(grid.getSize().y);
+	const BitGrid::Word* rows = lines > 0 ? grid.getRow(0u) : nullptr;
+
+	// Bits [x, x + 64) of row y, zero outside of the grid
+	auto getBits = [=] (int x, int y) -> BitGrid::Word
+	{
+		if (y < 0 || y >= lines)
+			return 0u;
+
+		int word = (x >= 0 ? x : x - wordBits + 1) / wordBits;
+		int shift = x - word * wordBits;
+		BitGrid::Word low 	= word >= 0 && word < words ? rows[y * words + word] : 0u;
+		BitGrid::Word high 	= word + 1 >= 0 && word + 1 < words ? rows[y * words + word + 1] : 0u;
+		return shift == 0 ? low : (low >> shift) | (high << (wordBits - shift));
+	};
+
+	if (dx > 0)
+	{
+		for (;; x += wordBits)
+		{
+			BitGrid::Word open = getBits(x, y);
+			BitGrid::Word stops = ~open
+				| (getBits(x, y - 1) & ~getBits(x - 1, y - 1))
+				| (getBits(x, y + 1) & ~getBits(x - 1, y + 1));
+			if (goalY == y && goalX >= x && goalX < x + wordBits)
+				stops |= BitGrid::Word(1u) << (goalX - x);
+
+			if (stops != 0u)
+			{
+				auto offset = BitGrid::countTrailingZeros(stops);
+				x += offset;
+				return (open >> offset) & 1u;
+			}
+		}
+	}
+	else
+	{
+		// Bit 63 is x, lower bits lie further back
+		for (;; x -= wordBits)
+		{
+			const int first = x - wordBits + 1;
+			BitGrid::Word open = getBits(first, y);
+			BitGrid::Word stops = ~open
+				| (getBits(first, y - 1) & ~getBits(first + 1, y - 1))
+				| (getBits(first, y + 1) & ~getBits(first + 1, y + 1));
+			if (goalY == y && goalX <= x && goalX >= first)
+				stops |= BitGrid::Word(1u) << (goalX - first);
+
+			if (stops != 0u)
+			{
+				auto offset = BitGrid::countLeadingZeros(stops);
+				x -= offset;
+				return (open >> (wordBits - 1 - offset)) & 1u;
+			}
+		}
+	}
+}
+
+bool Pathfinder::jumpDiagonal(int& x, int& y, int dx, int dy) const
+{
+	for (;; x += dx, y += dy)
+	{
+		if (!isWalkable(x, y))
+			return false;
+		if (Tile::ID(x, y) == mGoal)
+			return true;
+
+		// Stop where a straight jump along either component finds something
+		int hx = x + dx, hy = y;
+		int vx = x, vy = y + dy;
+		if (jumpStraight(hx, hy, dx, 0) || jumpStraight(vx, vy, 0, dy))
+			return true;
+
+		if (!isWalkable(x + dx, y) || !isWalkable(x, y + dy))
+			return false;
+	}
+}
+
+void Pathfinder::addJumpPoint(sf::Uint32 from, int dx, int dy)
+{
+	int fromX = from % mLevel.size.x;
+	int fromY = from / mLevel.size.x;
+	int x = fromX + dx;
+	int y = fromY + dy;
+	if (!(dx != 0 && dy != 0 ? jumpDiagonal(x, y, dx, dy) : jumpStraight(x, y, dx, dy)))
+		return;
+
+	sf::Uint32 index = x + y * mLevel.size.x;
+	const sf::Uint32 opened = 2u * mSearch;
+	if (mStamps[index] == opened + 1u)
+		return;
+
+	float cost = mCosts[from] + getDistance(fromX, fromY, x, y);
+	if (mStamps[index] != opened || cost < mCosts[index])
+	{
+		mStamps[index] = opened;
+		mCosts[index] = cost;
+		mParents[index] = from;
+		mOpenList.push_back(std::make_pair(cost + getDistance(x, y, mGoal.first, mGoal.second), index));
+		std::push_heap(mOpenList.begin(), mOpenList.end(), std::greater<std::pair<float, sf::Uint32>>());
+	}
+}
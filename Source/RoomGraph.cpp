@@ -0,0 +1,169 @@
+#include <Game/RoomGraph.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace
+{
+	const int Offsets[4][2] =
+	{
+		{ -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+	};
+
+	template <typename T>
+	void sortUnique(std::vector<T>& values)
+	{
+		std::sort(values.begin(), values.end());
+		values.erase(std::unique(values.begin(), values.end()), values.end());
+	}
+
+	std::size_t findRoot(std::vector<std::size_t>& parents, std::size_t node)
+	{
+		while (parents[node] != node)
+			node = parents[node] = parents[parents[node]];
+		return node;
+	}
+}
+
+RoomGraph::RoomGraph()
+: mRooms()
+, mCorridors()
+{
+}
+
+void RoomGraph::build(const Level& level, const BitGrid& walkable)
+{
+	const auto size = level.size;
+	mRooms.assign(level.rooms.size(), Room());
+	mCorridors.clear();
+
+	// Flood every corridor once. Movement never cuts corners, so 4-connected tiles are enough
+	BitGrid visited(size);
+	std::vector<Tile::ID> open;
+	for (auto y = 0u; y < size.y; ++y)
+		for (std::size_t word = 0u; word < walkable.getWordsPerRow(); ++word)
+		{
+			// Walls are skipped a word at a time
+			BitGrid::Word seeds = walkable.getRow(y)[word] & ~visited.getRow(y)[word];
+			while (seeds != 0u)
+			{
+				auto x = static_cast<unsigned int>(word * BitGrid::WordBits + BitGrid::countTrailingZeros(seeds));
+				seeds &= seeds - 1u;
+				if (level.roomIndices[x + y * size.x] != Level::NoRoom || visited.get(x, y))
+					continue;
+
+				auto corridorIndex = mCorridors.size();
+				mCorridors.push_back(Corridor());
+				Corridor& corridor = mCorridors.back();
+				visited.set(x, y, true);
+				open.assign(1u, Tile::ID(x, y));
+
+				while (!open.empty())
+				{
+					Tile::ID tile = open.back();
+					open.pop_back();
+					corridor.tiles.push_back(tile);
+
+					// Unsigned IDs wrap around when stepping off the left or top border
+					for (auto i = 0u; i < 4u; ++i)
+					{
+						Tile::ID neighbour(tile.first + Offsets[i][0], tile.second + Offsets[i][1]);
+						if (neighbour.first >= size.x || neighbour.second >= size.y || !walkable.get(neighbour.first, neighbour.second))
+							continue;
+
+						auto neighbourIndex = neighbour.first + neighbour.second * size.x;
+						auto room = level.roomIndices[neighbourIndex];
+						if (room != Level::NoRoom)
+						{
+							Door door = { tile, room };
+							corridor.doors.push_back(door);
+							corridor.rooms.push_back(room);
+						}
+						else if (!visited.get(neighbour.first, neighbour.second))
+						{
+							visited.set(neighbour.first, neighbour.second, true);
+							open.push_back(neighbour);
+						}
+					}
+				}
+
+				sortUnique(corridor.rooms);
+				FOREACH(Level::RoomIndex room, corridor.rooms)
+					mRooms[room].corridors.push_back(corridorIndex);
+			}
+		}
+
+	// Rooms never overlap but may share a border, checking right and bottom edges finds each pair once
+	auto link = [&] (std::size_t room, unsigned int x, unsigned int y, unsigned int nx, unsigned int ny)
+	{
+		if (nx >= size.x || ny >= size.y || !walkable.get(x, y) || !walkable.get(nx, ny))
+			return;
+
+		auto other = level.roomIndices[nx + ny * size.x];
+		if (other != Level::NoRoom && other != room)
+		{
+			mRooms[room].touching.push_back(other);
+			mRooms[other].touching.push_back(static_cast<Level::RoomIndex>(room));
+		}
+	};
+
+	for (std::size_t i = 0u; i < level.rooms.size(); ++i)
+	{
+		const sf::IntRect& room = level.rooms[i];
+		const unsigned int right = room.left + room.width - 1;
+		const unsigned int bottom = room.top + room.height - 1;
+		for (unsigned int y = room.top; y <= bottom; ++y)
+			link(i, right, y, right + 1u, y);
+		for (unsigned int x = room.left; x <= right; ++x)
+			link(i, x, bottom, x, bottom + 1u);
+	}
+
+	// Connected components, joined through corridors and shared borders
+	std::vector<std::size_t> parents(mRooms.size());
+	for (std::size_t i = 0u; i < parents.size(); ++i)
+		parents[i] = i;
+
+	FOREACH(Corridor& corridor, mCorridors)
+		for (std::size_t i = 1u; i < corridor.rooms.size(); ++i)
+			parents[findRoot(parents, corridor.rooms[i])] = findRoot(parents, corridor.rooms.front());
+
+	for (std::size_t i = 0u; i < mRooms.size(); ++i)
+	{
+		sortUnique(mRooms[i].touching);
+		FOREACH(Level::RoomIndex other, mRooms[i].touching)
+			parents[findRoot(parents, other)] = findRoot(parents, i);
+	}
+
+	for (std::size_t i = 0u; i < mRooms.size(); ++i)
+		mRooms[i].component = findRoot(parents, i);
+}
+
+const std::vector<RoomGraph::Room>& RoomGraph::getRooms() const
+{
+	return mRooms;
+}
+
+const std::vector<RoomGraph::Corridor>& RoomGraph::getCorridors() const
+{
+	return mCorridors;
+}
+
+void RoomGraph::getAdjacentRooms(Level::RoomIndex room, std::vector<Level::RoomIndex>& rooms) const
+{
+	assert(room < mRooms.size());
+	rooms.clear();
+	rooms.insert(rooms.end(), mRooms[room].touching.begin(), mRooms[room].touching.end());
+	FOREACH(std::size_t corridor, mRooms[room].corridors)
+		rooms.insert(rooms.end(), mCorridors[corridor].rooms.begin(), mCorridors[corridor].rooms.end());
+
+	sortUnique(rooms);
+	rooms.erase(std::remove(rooms.begin(), rooms.end(), room), rooms.end());
+}
+
+bool RoomGraph::isConnected(Level::RoomIndex from, Level::RoomIndex to) const
+{
+	assert(from < mRooms.size() && to < mRooms.size());
+	return mRooms[from].component == mRooms[to].component;
+}
@@ -121,23 +121,6 @@ unsigned int SceneNode::getCategory() const
 	return mDefaultCategory;
 }
 
-void SceneNode::checkSceneCollision(SceneNode& sceneGraph, std::set<Pair>& collisionPairs)
-{
-	checkNodeCollision(sceneGraph, collisionPairs);
-
-	FOREACH(Ptr& child, sceneGraph.mChildren)
-		checkSceneCollision(*child, collisionPairs);
-}
-
-void SceneNode::checkNodeCollision(SceneNode& node, std::set<Pair>& collisionPairs)
-{
-	if (this != &node && collision(*this, node) && !isDestroyed() && !node.isDestroyed())
-		collisionPairs.insert(std::minmax(this, &node));
-
-	FOREACH(Ptr& child, mChildren)
-		child->checkNodeCollision(node, collisionPairs);
-}
-
 void SceneNode::removeWrecks()
 {
 	// Remove all children which request so
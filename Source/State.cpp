@@ -2,13 +2,14 @@
 #include <Game/StateStack.hpp>
 
 
-State::Context::Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& fonts, Player& player, MusicPlayer& music, SoundPlayer& sounds)
+State::Context::Context(sf::RenderWindow& window, TextureHolder& textures, FontHolder& fonts, Player& player, MusicPlayer& music, SoundPlayer& sounds, ThreadPool& threads)
 : window(&window)
 , textures(&textures)
 , fonts(&fonts)
 , player(&player)
 , music(&music)
 , sounds(&sounds)
+, threads(&threads)
 {
 }
 
@@ -0,0 +1,222 @@
+#include <Game/SweepAndPrune.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace
+{
+	// Inserted nodes are sorted in one by one up to this many, past it all endpoints are sorted again
+	const std::size_t MaxSortedInserts = 16u;
+}
+
+SweepAndPrune::SweepAndPrune()
+: mProxies()
+, mFreeProxies()
+, mEndpoints()
+, mInsertCount(0u)
+, mPairs()
+, mMergedPairs()
+, mPairChanges()
+, mOverlapping()
+, mEntered()
+, mExited()
+{
+}
+
+void SweepAndPrune::insert(SceneNode& node)
+{
+	auto index = static_cast<sf::Uint32>(mProxies.size());
+	if (mFreeProxies.empty())
+		mProxies.push_back(Proxy());
+	else
+	{
+		index = mFreeProxies.back();
+		mFreeProxies.pop_back();
+	}
+
+	Proxy& proxy = mProxies[index];
+	proxy.node = &node;
+	proxy.bounds = node.getBoundingRect();
+
+	// Appended as if at the far right, the next sort moves them in and finds the pairs on the way
+	Endpoint min = { proxy.bounds.left, index, true, false };
+	Endpoint max = { proxy.bounds.left + proxy.bounds.width, index, false, false };
+	mEndpoints.push_back(min);
+	mEndpoints.push_back(max);
+	++mInsertCount;
+}
+
+void SweepAndPrune::remove(SceneNode& node)
+{
+	auto found = std::find_if(mProxies.begin(), mProxies.end(), [&node] (const Proxy& proxy) { return proxy.node == &node; });
+	assert(found != mProxies.end());
+	auto index = static_cast<sf::Uint32>(found - mProxies.begin());
+	found->node = nullptr;
+	mFreeProxies.push_back(index);
+
+	mEndpoints.erase(std::remove_if(mEndpoints.begin(), mEndpoints.end(), [index] (const Endpoint& endpoint)
+	{
+		return endpoint.proxy == index;
+	}), mEndpoints.end());
+
+	mPairs.erase(std::remove_if(mPairs.begin(), mPairs.end(), [index] (const CachedPair& pair)
+	{
+		return pair.first == index || pair.second == index;
+	}), mPairs.end());
+}
+
+void SweepAndPrune::update()
+{
+	mEntered.clear();
+	mExited.clear();
+
+	FOREACH(Proxy& proxy, mProxies)
+		if (proxy.node)
+			proxy.bounds = proxy.node->getBoundingRect();
+	FOREACH(Endpoint& endpoint, mEndpoints)
+	{
+		const sf::FloatRect& bounds = mProxies[endpoint.proxy].bounds;
+		endpoint.value = endpoint.isMin ? bounds.left : bounds.left + bounds.width;
+		endpoint.isEmpty = bounds.width <= 0.f;
+	}
+
+	if (mInsertCount > MaxSortedInserts)
+		sweepEndpoints();
+	else
+		sortEndpoints();
+	mInsertCount = 0u;
+	applyPairChanges();
+
+	// Overlapping on x is known, only the full bounds are left to compare
+	mOverlapping.clear();
+	FOREACH(CachedPair& pair, mPairs)
+	{
+		bool overlapping = mProxies[pair.first].bounds.intersects(mProxies[pair.second].bounds);
+		if (overlapping != pair.overlapping)
+			(overlapping ? mEntered : mExited).push_back(getNodes(pair));
+		if (overlapping)
+			mOverlapping.push_back(getNodes(pair));
+		pair.overlapping = overlapping;
+	}
+}
+
+const std::vector<SceneNode::Pair>& SweepAndPrune::getPairs() const
+{
+	return mOverlapping;
+}
+
+const std::vector<SceneNode::Pair>& SweepAndPrune::getEntered() const
+{
+	return mEntered;
+}
+
+const std::vector<SceneNode::Pair>& SweepAndPrune::getExited() const
+{
+	return mExited;
+}
+
+void SweepAndPrune::sortEndpoints()
+{
+	// Insertion sort, an endpoint passing another one changes whether their proxies overlap on x
+	for (auto i = 1u; i < mEndpoints.size(); ++i)
+	{
+		Endpoint endpoint = mEndpoints[i];
+		auto j = i;
+		for (; j > 0u && isBefore(endpoint, mEndpoints[j - 1u]); --j)
+		{
+			const Endpoint& passed = mEndpoints[j - 1u];
+			if (endpoint.proxy != passed.proxy && endpoint.isMin != passed.isMin)
+				mPairChanges.push_back(PairChange(getKey(endpoint.proxy, passed.proxy), endpoint.isMin ? 1 : -1));
+
+			mEndpoints[j] = passed;
+		}
+		mEndpoints[j] = endpoint;
+	}
+}
+
+void SweepAndPrune::sweepEndpoints()
+{
+	std::sort(mEndpoints.begin(), mEndpoints.end(), &SweepAndPrune::isBefore);
+
+	// Every cached pair is dropped and every pair found is added, the ones in both cancel out
+	FOREACH(const CachedPair& pair, mPairs)
+		mPairChanges.push_back(PairChange(getKey(pair.first, pair.second), -1));
+
+	// A proxy overlaps on x with those still open when its minimum comes
+	std::vector<sf::Uint32> open;
+	FOREACH(const Endpoint& endpoint, mEndpoints)
+	{
+		if (endpoint.isMin)
+		{
+			FOREACH(sf::Uint32 other, open)
+				mPairChanges.push_back(PairChange(getKey(endpoint.proxy, other), 1));
+			open.push_back(endpoint.proxy);
+		}
+		else
+		{
+			auto found = std::find(open.begin(), open.end(), endpoint.proxy);
+			*found = open.back();
+			open.pop_back();
+		}
+	}
+}
+
+void SweepAndPrune::applyPairChanges()
+{
+	std::sort(mPairChanges.begin(), mPairChanges.end());
+
+	// Both lists are sorted by key, a single pass merges them
+	mMergedPairs.clear();
+	auto pair = mPairs.begin();
+	for (auto change = mPairChanges.begin(); change != mPairChanges.end(); )
+	{
+		auto key = change->first;
+		auto count = 0;
+		for (; change != mPairChanges.end() && change->first == key; ++change)
+			count += change->second;
+
+		for (; pair != mPairs.end() && getKey(pair->first, pair->second) < key; ++pair)
+			mMergedPairs.push_back(*pair);
+
+		if (pair != mPairs.end() && getKey(pair->first, pair->second) == key)
+		{
+			if (count >= 0)
+				mMergedPairs.push_back(*pair);
+			else if (pair->overlapping)
+				mExited.push_back(getNodes(*pair));
+			++pair;
+		}
+		else if (count > 0)
+		{
+			CachedPair added = { static_cast<sf::Uint32>(key >> 32), static_cast<sf::Uint32>(key), false };
+			mMergedPairs.push_back(added);
+		}
+	}
+	mMergedPairs.insert(mMergedPairs.end(), pair, mPairs.end());
+
+	mPairs.swap(mMergedPairs);
+	mPairChanges.clear();
+}
+
+SceneNode::Pair SweepAndPrune::getNodes(const CachedPair& pair) const
+{
+	return std::minmax(mProxies[pair.first].node, mProxies[pair.second].node);
+}
+
+std::uint64_t SweepAndPrune::getKey(sf::Uint32 first, sf::Uint32 second)
+{
+	return static_cast<std::uint64_t>(std::min(first, second)) << 32 | std::max(first, second);
+}
+
+bool SweepAndPrune::isBefore(const Endpoint& lhs, const Endpoint& rhs)
+{
+	// On ties maxima come first, so touching extents do not overlap like sf::Rect::intersects().
+	// Empty extents go in between, their own minimum first
+	auto getTieOrder = [] (const Endpoint& endpoint)
+	{
+		return endpoint.isMin ? (endpoint.isEmpty ? 1 : 3) : (endpoint.isEmpty ? 2 : 0);
+	};
+	return lhs.value < rhs.value || (lhs.value == rhs.value && getTieOrder(lhs) < getTieOrder(rhs));
+}
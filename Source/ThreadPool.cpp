@@ -0,0 +1,99 @@
+#include <Game/ThreadPool.hpp>
+#include <Game/Foreach.hpp>
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+: mThreads()
+, mTasks()
+, mMutex()
+, mCondition()
+, mStopping(false)
+{
+	// The calling thread takes part in parallelFor(), so one less worker is needed
+	for (auto i = 1u; i < std::max<std::size_t>(threadCount, 1u); ++i)
+		mThreads.push_back(std::thread(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mCondition.notify_all();
+
+	FOREACH(std::thread& thread, mThreads)
+		thread.join();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const RangeTask& task)
+{
+	if (count == 0u)
+		return;
+
+	auto rangeCount = std::min(count, getThreadCount() * 4u);
+	auto rangeSize = (count + rangeCount - 1u) / rangeCount;
+	rangeCount = (count + rangeSize - 1u) / rangeSize;
+
+	// Guarded by mMutex, the last range to finish wakes the caller
+	std::size_t remaining = rangeCount - 1u;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto range = 1u; range < rangeCount; ++range)
+		{
+			auto begin = range * rangeSize;
+			auto end = std::min(begin + rangeSize, count);
+			mTasks.push([this, &task, &remaining, begin, end] ()
+			{
+				task(begin, end);
+
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (--remaining == 0u)
+					mCondition.notify_all();
+			});
+		}
+	}
+	mCondition.notify_all();
+
+	task(0u, std::min(rangeSize, count));
+
+	// Help with queued tasks while waiting, so nested calls cannot starve the pool
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;)
+	{
+		mCondition.wait(lock, [this, &remaining] () { return remaining == 0u || !mTasks.empty(); });
+		if (remaining == 0u)
+			return;
+
+		Task pending = std::move(mTasks.front());
+		mTasks.pop();
+		lock.unlock();
+		pending();
+		lock.lock();
+	}
+}
+
+std::size_t ThreadPool::getThreadCount() const
+{
+	return mThreads.size() + 1u;
+}
+
+void ThreadPool::work()
+{
+	for (;;)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this] () { return mStopping || !mTasks.empty(); });
+			if (mStopping && mTasks.empty())
+				return;
+
+			task = std::move(mTasks.front());
+			mTasks.pop();
+		}
+		task();
+	}
+}
@@ -1,17 +1,33 @@
 #include <Game/Tile.hpp>
 #include <Game/DataTables.hpp>
-#include <Game/Utility.hpp>
-#include <Game/ResourceHolder.hpp>
 
-#include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/RenderStates.hpp>
-
-
-using namespace std::placeholders;
 
 namespace
 {
 	const std::vector<TileData> Table 	= initializeTileData();
+
+	// Walls above a walkable tile show their front, walls with no walkable neighbour are never seen
+	constexpr Tile::Variant getVariant(unsigned int neighbours)
+	{
+		return neighbours == 0u ? Tile::Enclosed : (neighbours & Tile::South) ? Tile::Face : Tile::Top;
+	}
+
+	#define VARIANTS_4(i) 	getVariant(i), getVariant(i + 1u), getVariant(i + 2u), getVariant(i + 3u)
+	#define VARIANTS_16(i) 	VARIANTS_4(i), VARIANTS_4(i + 4u), VARIANTS_4(i + 8u), VARIANTS_4(i + 12u)
+	#define VARIANTS_64(i) 	VARIANTS_16(i), VARIANTS_16(i + 16u), VARIANTS_16(i + 32u), VARIANTS_16(i + 48u)
+
+	// Every neighbour mask resolved at compile time
+	constexpr Tile::Variant Variants[256] =
+	{
+		VARIANTS_64(0u), VARIANTS_64(64u), VARIANTS_64(128u), VARIANTS_64(192u),
+	};
+
+	#undef VARIANTS_64
+	#undef VARIANTS_16
+	#undef VARIANTS_4
+
+	static_assert(Variants[0] == Tile::Enclosed && Variants[Tile::South | Tile::North] == Tile::Face
+		&& Variants[Tile::North] == Tile::Top, "Tile variant table out of date");
 }
 
 const unsigned int Tile::Size = 16u;
@@ -24,19 +40,10 @@ Tile::Tile(const ID id, Type type)
 
 unsigned int Tile::getCategory() const
 {
-	switch (mType)
-	{
-		case Floor:
-		case TunnelFloor:
-			return Category::WalkableTile;
-		default:
-			return Category::Tile;
-	}
-}
-
-sf::FloatRect Tile::getBoundingRect() const
-{
-	return sf::FloatRect(mId.first * Tile::Size, mId.second * Tile::Size, Tile::Size, Tile::Size);
+	if (isWalkable(mType))
+		return Category::WalkableTile;
+	else
+		return Category::Tile;
 }
 
 Tile::ID Tile::getID() const
@@ -51,10 +58,33 @@ Tile::Type Tile::getType() const
 
 unsigned int Tile::getTilesetIndex() const
 {
-	return Table[mType].tilesetIndex;
+	return getTilesetIndex(mType);
 }
 
 bool Tile::isWalkable() const
 {
-	return getCategory() == Category::WalkableTile;
+	return isWalkable(mType);
+}
+
+unsigned int Tile::getTilesetIndex(Type type)
+{
+	return Table[type].tilesetIndices[Top];
+}
+
+unsigned int Tile::getTilesetIndex(Type type, sf::Uint8 neighbours)
+{
+	return Table[type].tilesetIndices[Variants[neighbours]];
+}
+
+bool Tile::isWalkable(Type type)
+{
+	switch (type)
+	{
+		case Floor:
+		case TunnelFloor:
+		case Stairs:
+			return true;
+		default:
+			return false;
+	}
 }
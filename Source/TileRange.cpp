@@ -0,0 +1,91 @@
+#include <Game/TileRange.hpp>
+
+#include <cassert>
+
+
+TileRange::Iterator::Iterator(sf::IntRect area, int x, int y)
+: mArea(area)
+, mX(x)
+, mY(y)
+{
+}
+
+Tile::ID TileRange::Iterator::operator*() const
+{
+	return Tile::ID(mX, mY);
+}
+
+TileRange::Iterator& TileRange::Iterator::operator++()
+{
+	if (++mY == mArea.top + mArea.height)
+	{
+		mY = mArea.top;
+		++mX;
+	}
+	return *this;
+}
+
+bool TileRange::Iterator::operator!=(const Iterator& other) const
+{
+	return mX != other.mX || mY != other.mY;
+}
+
+TileRange::TileRange()
+: mArea()
+{
+}
+
+TileRange::TileRange(sf::IntRect area)
+: mArea(area)
+{
+	// Empty areas iterate nothing
+	if (mArea.width <= 0 || mArea.height <= 0)
+		mArea = sf::IntRect();
+}
+
+TileRange::Iterator TileRange::begin() const
+{
+	return Iterator(mArea, mArea.left, mArea.top);
+}
+
+TileRange::Iterator TileRange::end() const
+{
+	return Iterator(mArea, mArea.left + mArea.width, mArea.top);
+}
+
+std::size_t TileRange::size() const
+{
+	return static_cast<std::size_t>(mArea.width) * mArea.height;
+}
+
+bool TileRange::empty() const
+{
+	return size() == 0u;
+}
+
+TileNeighbours::TileNeighbours()
+: mIds()
+, mSize(0u)
+{
+}
+
+void TileNeighbours::push(Tile::ID id)
+{
+	assert(mSize < Capacity);
+	mIds[mSize++] = id;
+}
+
+const Tile::ID* TileNeighbours::begin() const
+{
+	return mIds;
+}
+
+const Tile::ID* TileNeighbours::end() const
+{
+	return mIds + mSize;
+}
+
+std::size_t TileNeighbours::size() const
+{
+	return mSize;
+}
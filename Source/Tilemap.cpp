@@ -2,285 +2,500 @@
 #include <Game/Foreach.hpp>
 #include <Game/Utility.hpp>
 #include <Game/ResourceHolder.hpp>
+#include <Game/ThreadPool.hpp>
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/View.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 
-Tilemap::Tilemap(const TextureHolder& textures)
+const unsigned int Tilemap::ChunkSize = 16u;
+
+namespace
+{
+	// Tiles seen before but out of sight are dimmed, tiles never seen are black
+	const unsigned int SightRadius = 12u;
+	const sf::Color ExploredColor(80, 80, 100);
+	// Visible tiles out of reach of every light
+	const sf::Color AmbientColor(110, 110, 130);
+
+	// In tiles, bounds merely touching a tile edge do not overlap that tile
+	const float SweepEpsilon = 1e-3f;
+
+	// Packs three walkable spans, top to bottom, into a Tile::Neighbour mask
+	sf::Uint8 packNeighbours(unsigned int above, unsigned int middle, unsigned int below)
+	{
+		return static_cast<sf::Uint8>(
+			  (above & 1u) * Tile::NorthWest | (above >> 1 & 1u) * Tile::North | (above >> 2 & 1u) * Tile::NorthEast
+			| (middle & 1u) * Tile::West | (middle >> 2 & 1u) * Tile::East
+			| (below & 1u) * Tile::SouthWest | (below >> 1 & 1u) * Tile::South | (below >> 2 & 1u) * Tile::SouthEast);
+	}
+
+	std::vector<sf::Vector2f> computeTexCoords(const sf::Texture& tileset)
+	{
+		const float size = static_cast<float>(Tile::Size);
+		std::vector<sf::Vector2f> texCoords;
+		for (auto tv = 0u; tv < tileset.getSize().y / Tile::Size; ++tv)
+			for (auto tu = 0u; tu < tileset.getSize().x / Tile::Size; ++tu)
+			{
+				texCoords.push_back(sf::Vector2f(tu * size, tv * size));
+				texCoords.push_back(sf::Vector2f((tu + 1) * size, tv * size));
+				texCoords.push_back(sf::Vector2f((tu + 1) * size, (tv + 1) * size));
+				texCoords.push_back(sf::Vector2f(tu * size, (tv + 1) * size));
+			}
+		return texCoords;
+	}
+}
+
+Tilemap::Tilemap(const TextureHolder& textures, ThreadPool& threads, unsigned int seed, DungeonGenerator::Layout layout)
 : SceneNode(Category::Tilemap)
 , mTileset(textures.get(Textures::Tiles))
-, mSize()
+, mTexCoords(computeTexCoords(mTileset))
+, mThreads(&threads)
+, mLevel()
+, mLevelFile()
+, mTiles(nullptr)
+, mWalkable()
+, mPathfinder(mLevel, mWalkable)
+, mRoomGraph()
+, mFieldOfView(SightRadius)
+, mViewpoint()
+, mViewRevision(0u)
+, mLightMap()
 , mBounds()
-, mImage()
-, mMap()
-, mRooms()
+, mChunkCount()
+, mChunks()
+, mDirtyTiles()
+, mRevision(0u)
 {
-	generateMap();	
+	DungeonGenerator generator(threads);
+	generator.generate(mLevel, seed, layout);
+	mTiles = mLevel.tiles.data();
+	generator.computeWalkability(mTiles, mLevel.size, mWalkable);
+	mRoomGraph.build(mLevel, mWalkable);
+	mFieldOfView.reset(mLevel.size);
+	mLightMap.rebuild(mWalkable);
+	mBounds = sf::FloatRect(0.f, 0.f, mLevel.size.x * Tile::Size, mLevel.size.y * Tile::Size);
 	generateMapImage();
 }
 
-void Tilemap::addTile(Tile::ID id, Tile::Type type)
+Tilemap::Tilemap(const TextureHolder& textures, ThreadPool& threads, const std::string& filename)
+: SceneNode(Category::Tilemap)
+, mTileset(textures.get(Textures::Tiles))
+, mTexCoords(computeTexCoords(mTileset))
+, mThreads(&threads)
+, mLevel()
+, mLevelFile()
+, mTiles(nullptr)
+, mWalkable()
+, mPathfinder(mLevel, mWalkable)
+, mRoomGraph()
+, mFieldOfView(SightRadius)
+, mViewpoint()
+, mViewRevision(0u)
+, mLightMap()
+, mBounds()
+, mChunkCount()
+, mChunks()
+, mDirtyTiles()
+, mRevision(0u)
 {
-	if (mMap.find(id) != mMap.end() && validateTile(id))
-		mMap.erase(id);
-	TilePtr tile = std::make_shared<Tile>(id, type);
-	tile->setPosition(id.first * Tile::Size, id.second * Tile::Size);
-	mMap[id] = tile;
+	// Prebaked level, the tiles are used in place from the mapped file
+	mLevelFile.load(filename, mLevel);
+	mTiles = mLevelFile.getTiles();
+	DungeonGenerator generator(threads);
+	generator.computeWalkability(mTiles, mLevel.size, mWalkable);
+	mRoomGraph.build(mLevel, mWalkable);
+	mFieldOfView.reset(mLevel.size);
+	mLightMap.rebuild(mWalkable);
+	mBounds = sf::FloatRect(0.f, 0.f, mLevel.size.x * Tile::Size, mLevel.size.y * Tile::Size);
+	generateMapImage();
+}
+
+Tile Tilemap::getTile(Tile::ID id) const
+{
+	return Tile(id, getTileType(id));
 }
 
-Tilemap::TilePtr Tilemap::getTile(Tile::ID id)
+Tile Tilemap::getTile(sf::Vector2f position) const
 {	
+	return getTile(getTileID(position));
+}
+
+sf::FloatRect Tilemap::getTileBounds(Tile::ID id) const
+{
+	return getTransform().transformRect(sf::FloatRect(id.first * Tile::Size, id.second * Tile::Size, Tile::Size, Tile::Size));
+}
+
+Tile::Type Tilemap::getTileType(Tile::ID id) const
+{
 	assert(validateTile(id));
-	return mMap[id];
+	return mTiles[getIndex(id)];
 }
 
-Tilemap::TilePtr Tilemap::getTile(sf::Vector2f position)
-{	
-	Tile::ID id(position.x / Tile::Size, position.y / Tile::Size);
-	return getTile(id);
+void Tilemap::setTileType(Tile::ID id, Tile::Type type)
+{
+	assert(validateTile(id));
+	mTiles[getIndex(id)] = type;
+	mWalkable.set(id.first, id.second, Tile::isWalkable(type));
+	// The neighbours' wall variants may change as well
+	mDirtyTiles.push_back(id);
+	TileNeighbours neighbours = getNeighbours(id);
+	FOREACH(Tile::ID neighbour, neighbours)
+		mDirtyTiles.push_back(neighbour);
+	mLightMap.updateTile(mWalkable, id, mDirtyTiles);
+	mPathfinder.clearCache();
+	++mRevision;
+}
+
+bool Tilemap::isWalkable(Tile::ID id) const
+{
+	assert(validateTile(id));
+	return mWalkable.get(id.first, id.second);
 }
 
-void Tilemap::getNeighbours(Tile::ID id, std::vector<TilePtr>& neighbours)
+sf::Vector2f Tilemap::sweep(sf::FloatRect bounds, sf::Vector2f motion) const
 {
-	if (validateTile(Tile::ID(id.first - 1u, id.second - 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first - 1u, id.second - 1u)));
+	// Tile units; the tilemap is only ever translated
+	const float size = static_cast<float>(Tile::Size);
+	bounds = getInverseTransform().transformRect(bounds);
+	bounds = sf::FloatRect(bounds.left / size, bounds.top / size, bounds.width / size, bounds.height / size);
+	motion /= size;
+
+	// One axis after the other, blocked on one axis the bounds still slide along the other
+	motion.x = sweepAxis(bounds, motion.x, true);
+	bounds.left += motion.x;
+	motion.y = sweepAxis(bounds, motion.y, false);
+	return motion * size;
+}
 
-	if (validateTile(Tile::ID(id.first - 1u, id.second)))
-		neighbours.push_back(getTile(Tile::ID(id.first - 1u, id.second)));
+TileNeighbours Tilemap::getNeighbours(Tile::ID id) const
+{
+	TileNeighbours neighbours;
+	for (auto dx = -1; dx <= 1; ++dx)
+		for (auto dy = -1; dy <= 1; ++dy)
+		{
+			// Unsigned IDs wrap around when stepping off the left or top border
+			Tile::ID neighbour(id.first + dx, id.second + dy);
+			if ((dx != 0 || dy != 0) && validateTile(neighbour))
+				neighbours.push(neighbour);
+		}
+	return neighbours;
+}
 
-	if (validateTile(Tile::ID(id.first - 1u, id.second + 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first - 1u, id.second + 1u)));
+TileNeighbours Tilemap::getNeighbours(sf::Vector2f position) const
+{
+	return getNeighbours(getTileID(position));
+}
 
-	if (validateTile(Tile::ID(id.first, id.second - 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first, id.second - 1u)));
+TileRange Tilemap::getRoom(Tile::ID id) const
+{
+	auto index = getRoomIndex(id);
+	if (index == Level::NoRoom)
+		return TileRange();
 
-	if (validateTile(Tile::ID(id.first, id.second + 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first, id.second + 1u)));
+	return TileRange(mLevel.rooms[index]);
+}
 
-	if (validateTile(Tile::ID(id.first + 1u, id.second - 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first + 1u, id.second - 1u)));
+TileRange Tilemap::getRoom(sf::Vector2f position) const
+{
+	return getRoom(getTileID(position));
+}
 
-	if (validateTile(Tile::ID(id.first + 1u, id.second)))
-		neighbours.push_back(getTile(Tile::ID(id.first + 1u, id.second)));
+Level::RoomIndex Tilemap::getRoomIndex(Tile::ID id) const
+{
+	return validateTile(id) ? mLevel.getRoomIndex(id.first, id.second) : Level::NoRoom;
+}
 
-	if (validateTile(Tile::ID(id.first + 1u, id.second + 1u)))
-		neighbours.push_back(getTile(Tile::ID(id.first + 1u, id.second + 1u)));					
+const RoomGraph& Tilemap::getRoomGraph() const
+{
+	return mRoomGraph;
 }
 
-void Tilemap::getNeighbours(sf::Vector2f position, std::vector<TilePtr>& neighbours)
+const std::vector<sf::IntRect>& Tilemap::getRooms() const
 {
-	Tile::ID id(position.x / Tile::Size, position.y / Tile::Size);
-	getNeighbours(id, neighbours);
+	return mLevel.rooms;
 }
 
-void Tilemap::getRoom(Tile::ID id, std::vector<TilePtr>& tiles)
+sf::Vector2f Tilemap::getRandomSpawnPoint(std::default_random_engine& random)
 {
-	if (validateTile(id))
-	{
-		for (auto roomItr = mRooms.begin(); roomItr != mRooms.end(); ++roomItr)
-		{			
-			sf::IntRect room = *roomItr->get();
-			if (room.contains(id.first, id.second))
-			{
-				for (auto x = room.left; x < room.left + room.width; ++x)
-					for (auto y = room.top; y < room.top + room.height; ++y)
-					{
-						tiles.push_back(getTile(Tile::ID(x, y)));
-					}
-			}
-		}
-	}
+	unsigned int index = randomInt(mLevel.spawns.size(), random);
+	assert(index < mLevel.spawns.size());
+	auto spawn = mLevel.spawns[index];
+	return getTransform().transformPoint(spawn.x * Tile::Size, spawn.y * Tile::Size);
 }
 
-void Tilemap::getRoom(sf::Vector2f position, std::vector<TilePtr>& tiles)
+bool Tilemap::findPath(Tile::ID start, Tile::ID goal, Pathfinder::Path& path)
 {
-	Tile::ID id(position.x / Tile::Size, position.y / Tile::Size);
-	getRoom(id, tiles);
+	return mPathfinder.findPath(start, goal, path);
 }
 
-void Tilemap::getRooms(std::vector<TilePtr>& tiles)
+void Tilemap::updateFieldOfView(Tile::ID viewpoint)
 {
-	for (auto roomItr = mRooms.begin(); roomItr != mRooms.end(); ++roomItr)
-	{
-		sf::IntRect room = *roomItr->get();
-		Tile::ID id(room.left, room.top);
-		getRoom(id, tiles);
-	}
+	// The viewpoint tile is always visible once computed
+	if (!validateTile(viewpoint) || (viewpoint == mViewpoint && mRevision == mViewRevision && mFieldOfView.isVisible(viewpoint)))
+		return;
+
+	mViewpoint = viewpoint;
+	mViewRevision = mRevision;
+	// Only the tiles entering or leaving sight are recoloured
+	mFieldOfView.compute(mWalkable, viewpoint, mDirtyTiles);
+}
+
+bool Tilemap::isVisible(Tile::ID id) const
+{
+	assert(validateTile(id));
+	return mFieldOfView.isVisible(id);
+}
+
+bool Tilemap::isExplored(Tile::ID id) const
+{
+	assert(validateTile(id));
+	return mFieldOfView.isExplored(id);
 }
 
-sf::Vector2f Tilemap::getRandomRoomCenter()
+LightMap::LightID Tilemap::addLight(Tile::ID position, sf::Color color, unsigned int radius)
 {
-	unsigned int index = randomInt(mRooms.size());
-	assert(index < mRooms.size());
-	auto roomCenter = getCenter(*mRooms[index]);
-	return sf::Vector2f(roomCenter.x * Tile::Size, roomCenter.y * Tile::Size);
+	return mLightMap.addLight(mWalkable, position, color, radius, mDirtyTiles);
+}
+
+void Tilemap::moveLight(LightMap::LightID light, Tile::ID position)
+{
+	mLightMap.moveLight(mWalkable, light, position, mDirtyTiles);
+}
+
+void Tilemap::removeLight(LightMap::LightID light)
+{
+	mLightMap.removeLight(light, mDirtyTiles);
 }
 
 sf::FloatRect Tilemap::getBoundingRect() const
 {
-	return mBounds;
+	return getWorldTransform().transformRect(mBounds);
+}
+
+sf::Vector2u Tilemap::getSize() const
+{
+	return mLevel.size;
+}
+
+unsigned int Tilemap::getRevision() const
+{
+	return mRevision;
+}
+
+void Tilemap::setThreadPool(ThreadPool& threads)
+{
+	mThreads = &threads;
 }
 
 void Tilemap::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
 {
-	states.transform *= getTransform();
 	states.texture = &mTileset;
-	target.draw(mImage, states);
+
+	// Only submit the chunks intersecting the current view
+	const sf::View& view = target.getView();
+	auto viewBounds = states.transform.getInverse().transformRect(sf::FloatRect(view.getCenter() - view.getSize() / 2.f, view.getSize()));
+	const float chunkSize = static_cast<float>(ChunkSize * Tile::Size);
+	int left 	= std::max(0, static_cast<int>(std::floor(viewBounds.left / chunkSize)));
+	int top 	= std::max(0, static_cast<int>(std::floor(viewBounds.top / chunkSize)));
+	int right 	= std::min(static_cast<int>(mChunkCount.x), static_cast<int>(std::ceil((viewBounds.left + viewBounds.width) / chunkSize)));
+	int bottom 	= std::min(static_cast<int>(mChunkCount.y), static_cast<int>(std::ceil((viewBounds.top + viewBounds.height) / chunkSize)));
+	for (auto y = top; y < bottom; ++y)
+		for (auto x = left; x < right; ++x)
+			target.draw(mChunks[x + y * mChunkCount.x], states);
 }
 	
 void Tilemap::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
-	// TODO: update tiles and vertex array? not now.
+	// Only the quads of the tiles changed since the last frame are rewritten
+	FOREACH(Tile::ID id, mDirtyTiles)
+		updateQuad(id, getNeighbourMask(id));
+	mDirtyTiles.clear();
 }
 
-bool Tilemap::validateTile(Tile::ID id)
+bool Tilemap::validateTile(Tile::ID id) const
 {
-    return id.first >= 0 && id.first < mSize.x && id.second >= 0 && id.second < mSize.y;
+	// Unsigned IDs wrap around when stepping off the left or top border
+	return id.first < mLevel.size.x && id.second < mLevel.size.y;
 }
 
-void Tilemap::createRoom(sf::IntRect bounds)
-{	
-	Tile::ID id(bounds.left, bounds.top);
-	BoundsPtr room(new sf::IntRect(bounds.left, bounds.top, bounds.width, bounds.height));
-	mRooms.push_back(std::move(room));
-	for (auto x = bounds.left; x < bounds.left + bounds.width; ++x)
-		for (auto y = bounds.top; y < bounds.top + bounds.height; ++y)
-		{
-			Tile::ID id(x,y);
-			if (id.first == 0u || id.first == mSize.x - 1u || id.second == 0u || id.second == mSize.y - 1u)
-				addTile(id, Tile::Type::Wall);
-			else
-				addTile(id, Tile::Type::Floor);
-		}
+std::size_t Tilemap::getIndex(Tile::ID id) const
+{
+	return id.first + id.second * mLevel.size.x;
 }
 
-void Tilemap::createTunnelH(int x1, int x2, int y)
+float Tilemap::sweepAxis(sf::FloatRect bounds, float motion, bool horizontal) const
 {
-	for (auto x = std::min(x1, x2); x < std::max(x1, x2) + 1; ++x)
-	{		
-		addTile(Tile::ID(x, y), Tile::Type::Floor);
+	const float start 	= horizontal ? bounds.left : bounds.top;
+	const float length 	= horizontal ? bounds.width : bounds.height;
+	const float across 	= horizontal ? bounds.top : bounds.left;
+	const float breadth = horizontal ? bounds.height : bounds.width;
+	const int first = static_cast<int>(std::floor(across + SweepEpsilon));
+	const int last 	= static_cast<int>(std::ceil(across + breadth - SweepEpsilon)) - 1;
+
+	// Every row or column of tiles passed is checked, however long the motion
+	auto isBlocked = [&] (int line)
+	{
+		for (auto i = first; i <= last; ++i)
+			if (horizontal ? isSolid(line, i) : isSolid(i, line))
+				return true;
+		return false;
+	};
+
+	if (motion == 0.f)
+		return motion;
+
+	// Bounds already overlapping a wall may only move out of it: solid lines they overlap
+	// block the motion when they lie on the half of the bounds it heads to
+	const float center = start + length / 2.f;
+	const int overlapFirst = static_cast<int>(std::floor(start + SweepEpsilon));
+	const int overlapLast = static_cast<int>(std::ceil(start + length - SweepEpsilon)) - 1;
+	for (auto line = overlapFirst; line <= overlapLast; ++line)
+	{
+		const bool ahead = motion > 0.f ? line + 0.5f >= center : line + 0.5f <= center;
+		if (ahead && isBlocked(line))
+			return 0.f;
 	}
+
+	if (motion > 0.f)
+	{
+		const float edge = start + length;
+		const int end = static_cast<int>(std::ceil(edge + motion)) - 1;
+		for (auto line = overlapLast + 1; line <= end; ++line)
+			if (isBlocked(line))
+				return line - edge;
+	}
+	else
+	{
+		const int end = static_cast<int>(std::floor(start + motion));
+		for (auto line = overlapFirst - 1; line >= end; --line)
+			if (isBlocked(line))
+				return line + 1 - start;
+	}
+	return motion;
 }
 
-void Tilemap::createTunnelV(int y1, int y2, int x)
+bool Tilemap::isSolid(int x, int y) const
 {
-	for (auto y = std::min(y1, y2); y < std::max(y1, y2) + 1; ++y)
-	{		
-		addTile(Tile::ID(x, y), Tile::Type::Floor);
-	}
+	return x < 0 || y < 0 || x >= static_cast<int>(mLevel.size.x) || y >= static_cast<int>(mLevel.size.y)
+		|| !mWalkable.get(x, y);
 }
 
-void Tilemap::generateMap()
-{	
-	// TODO: improve generation...
-	int randomFactor = 2;
-	int randomFactorX = 1 + randomInt(randomFactor);
-	int randomFactorY = 1 + randomInt(randomFactor);
-	mSize.x = 10u + 10 * randomFactorX;
-	mSize.y = 10u + 10 * randomFactorY;
-	mBounds = sf::FloatRect(0.f, 0.f, mSize.x * Tile::Size, mSize.y * Tile::Size);
-	// Fills the map, easier to manage
-	for (auto x = 0u; x < mSize.x; ++x)
-		for (auto y = 0u; y < mSize.y; ++y)
-		{
-			Tile::ID id(x, y);	
-			addTile(id, Tile::Type::None);
-		}
+Tile::ID Tilemap::getTileID(sf::Vector2f position) const
+{
+	auto local = getInverseTransform().transformPoint(position);
+	return Tile::ID(local.x / Tile::Size, local.y / Tile::Size);
+}
+
+void Tilemap::generateMapImage()
+{
+	mChunkCount.x = (mLevel.size.x + ChunkSize - 1) / ChunkSize;
+	mChunkCount.y = (mLevel.size.y + ChunkSize - 1) / ChunkSize;
+	mChunks.assign(mChunkCount.x * mChunkCount.y, sf::VertexArray(sf::Quads));
 
-	auto maxRooms 		= std::max(mSize.x, mSize.y) / std::min(randomFactorX, randomFactorY);
-	auto roomMinSize 	= 3u;
-	auto roomMaxSize 	= 10u;
-	auto numberRooms 	= 0u;
-	// Generate Rooms (Floor)
-	for (auto i = 0u; i < maxRooms; ++i)
+	// Chunks do not share vertices, each one is built independently
+	mThreads->parallelFor(mChunks.size(), [this] (std::size_t begin, std::size_t end)
 	{
-        auto width 	= roomMinSize + randomInt(roomMaxSize);
-        auto height = roomMinSize + randomInt(roomMaxSize);
-        auto x 		= randomInt(mSize.x - width - 1);
-        auto y 		= randomInt(mSize.y - height - 1);
-
-        sf::IntRect newRoom(x, y, width, height);
-		bool failed = false;
-		for (auto roomItr = mRooms.begin(); roomItr != mRooms.end(); ++roomItr)
-		{			
-			sf::IntRect room = *roomItr->get();
-			if (newRoom.intersects(room))
-			{
-				failed = true;
-				break;
-			}
-		}
-		if (!failed)
+		for (auto chunk = begin; chunk < end; ++chunk)
 		{
-			auto newRoomCenter = getCenter(newRoom);
-			if (numberRooms > 0)
+			auto left 	= static_cast<unsigned int>(chunk % mChunkCount.x) * ChunkSize;
+			auto top 	= static_cast<unsigned int>(chunk / mChunkCount.x) * ChunkSize;
+			// Border chunks may be smaller than ChunkSize x ChunkSize
+			auto width 	= std::min(ChunkSize, mLevel.size.x - left);
+			auto height = std::min(ChunkSize, mLevel.size.y - top);
+			mChunks[chunk].resize(width * height * 4);
+
+			// Quads are stored row by row, so the chunk is written front to back
+			sf::Vertex* quad = &mChunks[chunk][0];
+			for (auto y = top; y < top + height; ++y)
 			{
-				auto previousRoomCenter = getCenter(*mRooms[numberRooms - 1]);
-				
-	            if (randomInt(2))
-	            {
-	                createTunnelH(previousRoomCenter.x, newRoomCenter.x, previousRoomCenter.y);
-	                createTunnelV(previousRoomCenter.y, newRoomCenter.y, newRoomCenter.x);
-	            }
-	            else
-	            {
-	                createTunnelV(previousRoomCenter.y, newRoomCenter.y, previousRoomCenter.x);
-	                createTunnelH(previousRoomCenter.x, newRoomCenter.x, newRoomCenter.y);
-				}				
-			}	
-			createRoom(newRoom);			
-			++numberRooms;	
-		}			
-	}
-	// Generate Walls
-	for (auto x = 0u; x < mSize.x; ++x)
-		for (auto y = 0u; y < mSize.y; ++y)
-		{
-			
-			auto tile = mMap[Tile::ID(x,y)];
-			auto type = tile->getType();			
-			if (type == Tile::Type::None)
-			{
-				std::vector<Tilemap::TilePtr> neighbours;
-				getNeighbours(tile->getID(), neighbours);
-				FOREACH (auto neighbour, neighbours)
-				{
-					if (neighbour->isWalkable())
-					{
-						addTile(tile->getID(), Tile::Type::Wall);
-						tile = mMap[Tile::ID(x,y)];
-					}	
-				}
+				// Walkable bits of the three rows around the tile, shifted along as x advances
+				auto above 	= getWalkableSpan(Tile::ID(left, y - 1u), width + 2u);
+				auto middle = getWalkableSpan(Tile::ID(left, y), width + 2u);
+				auto below 	= getWalkableSpan(Tile::ID(left, y + 1u), width + 2u);
+				const Tile::Type* tiles = mTiles + getIndex(Tile::ID(left, y));
+				for (auto x = left; x < left + width; ++x, quad += 4, above >>= 1, middle >>= 1, below >>= 1)
+					setQuad(quad, Tile::ID(x, y), Tile::getTilesetIndex(tiles[x - left], packNeighbours(above, middle, below)));
 			}
 		}
+	});
+
+	// Pending edits are part of the new image
+	mDirtyTiles.clear();
 }
 
-void Tilemap::generateMapImage()
+void Tilemap::updateQuad(Tile::ID id, sf::Uint8 neighbours)
 {
-	mImage.setPrimitiveType(sf::Quads);
-    mImage.resize(mSize.x * mSize.y * 4);
-	for (auto x = 0u; x < mSize.x; ++x)
-		for (auto y = 0u; y < mSize.y; ++y)
-		{
-			auto tilesetIndex = mMap[Tile::ID(x,y)]->getTilesetIndex();
+	setQuad(getQuad(id), id, Tile::getTilesetIndex(mTiles[getIndex(id)], neighbours));
+}
 
-			auto tu = tilesetIndex % (mTileset.getSize().x / Tile::Size);
-			auto tv = tilesetIndex / (mTileset.getSize().x / Tile::Size);
+void Tilemap::setQuad(sf::Vertex* quad, Tile::ID id, unsigned int tilesetIndex) const
+{
+	const float size = static_cast<float>(Tile::Size);
+	const float x = id.first * size;
+	const float y = id.second * size;
+	const sf::Vector2f* texCoords = &mTexCoords[tilesetIndex * 4];
+
+	quad[0].position = sf::Vector2f(x, y);
+	quad[1].position = sf::Vector2f(x + size, y);
+	quad[2].position = sf::Vector2f(x + size, y + size);
+	quad[3].position = sf::Vector2f(x, y + size);
+
+	quad[0].texCoords = texCoords[0];
+	quad[1].texCoords = texCoords[1];
+	quad[2].texCoords = texCoords[2];
+	quad[3].texCoords = texCoords[3];
+
+	const sf::Color color = getTileColor(id);
+	for (auto i = 0u; i < 4u; ++i)
+		quad[i].color = color;
+}
+
+sf::Color Tilemap::getTileColor(Tile::ID id) const
+{
+	if (mFieldOfView.isVisible(id))
+		return mLightMap.getColor(id, AmbientColor);
+	else if (mFieldOfView.isExplored(id))
+		return ExploredColor;
+	else
+		return sf::Color::Black;
+}
 
-			sf::Vertex* quad = &mImage[(x + y * mSize.x) * 4];
+unsigned int Tilemap::getWalkableSpan(Tile::ID id, unsigned int count) const
+{
+	assert(count <= 32u);
 
-			quad[0].position = sf::Vector2f(x * Tile::Size, y * Tile::Size);
-			quad[1].position = sf::Vector2f((x + 1) * Tile::Size, y * Tile::Size);
-			quad[2].position = sf::Vector2f((x + 1) * Tile::Size, (y + 1) * Tile::Size);
-			quad[3].position = sf::Vector2f(x * Tile::Size, (y + 1) * Tile::Size);
+	// Unsigned IDs wrap around when stepping off the left or top border
+	if (id.second >= mLevel.size.y)
+		return 0u;
 
-			quad[0].texCoords = sf::Vector2f(tu * Tile::Size, tv * Tile::Size);
-			quad[1].texCoords = sf::Vector2f((tu + 1) * Tile::Size, tv * Tile::Size);
-			quad[2].texCoords = sf::Vector2f((tu + 1) * Tile::Size, (tv + 1) * Tile::Size);
-			quad[3].texCoords = sf::Vector2f(tu * Tile::Size, (tv + 1) * Tile::Size);
-		}
+	const BitGrid::Word* row = mWalkable.getRow(id.second);
+	unsigned int span = 0u;
+	for (auto i = 0u; i < count; ++i)
+	{
+		auto x = id.first + i - 1u;
+		if (x < mLevel.size.x && ((row[x / BitGrid::WordBits] >> (x % BitGrid::WordBits)) & 1u))
+			span |= 1u << i;
+	}
+	return span;
+}
+
+sf::Uint8 Tilemap::getNeighbourMask(Tile::ID id) const
+{
+	return packNeighbours(getWalkableSpan(Tile::ID(id.first, id.second - 1u)), getWalkableSpan(id), getWalkableSpan(Tile::ID(id.first, id.second + 1u)));
+}
+
+sf::Vertex* Tilemap::getQuad(Tile::ID id)
+{
+	auto chunkX 	= id.first / ChunkSize;
+	auto chunkY 	= id.second / ChunkSize;
+	auto width 		= std::min(ChunkSize, mLevel.size.x - chunkX * ChunkSize);
+	auto localX 	= id.first - chunkX * ChunkSize;
+	auto localY 	= id.second - chunkY * ChunkSize;
+	return &mChunks[chunkX + chunkY * mChunkCount.x][(localX + localY * width) * 4];
 }
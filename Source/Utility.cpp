@@ -171,9 +171,19 @@ float toRadian(float degree)
 }
 
 int randomInt(int exclusiveMax)
+{
+	return randomInt(exclusiveMax, RandomEngine);
+}
+
+int randomInt(int exclusiveMax, std::default_random_engine& engine)
 {
 	std::uniform_int_distribution<> distr(0, exclusiveMax - 1);
-	return distr(RandomEngine);
+	return distr(engine);
+}
+
+unsigned int randomSeed()
+{
+	return static_cast<unsigned int>(RandomEngine());
 }
 
 float length(sf::Vector2f vector)
@@ -0,0 +1,119 @@
+#include <Game/DungeonGenerator.hpp>
+#include <Game/LevelFile.hpp>
+#include <Game/ThreadPool.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Saves a generated level, loads it back and checks that corrupt copies are
+// rejected with an exception instead of being loaded.
+//
+// Usage: LevelFileTest
+
+namespace
+{
+	const std::string Filename = "LevelFileTest.level";
+
+	int failures = 0;
+
+	void check(bool condition, const std::string& what)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << what << std::endl;
+			++failures;
+		}
+	}
+
+	bool loads(const std::string& filename)
+	{
+		try
+		{
+			Level level;
+			LevelFile file;
+			file.load(filename, level);
+			return true;
+		}
+		catch (std::runtime_error&)
+		{
+			return false;
+		}
+	}
+
+	bool loads(const Level& level)
+	{
+		LevelFile::save(level, Filename);
+		return loads(Filename);
+	}
+}
+
+int main()
+{
+	ThreadPool threads(1u);
+	DungeonGenerator generator(threads);
+	Level original;
+	generator.generate(original, sf::Vector2u(64u, 64u), 7u);
+
+	// Round trip
+	{
+		LevelFile::save(original, Filename);
+		Level level;
+		LevelFile file;
+		file.load(Filename, level);
+		const Tile::Type* tiles = file.getTiles();
+		check(level.seed == original.seed && level.size == original.size, "header round trip");
+		check(level.rooms == original.rooms && level.tunnels == original.tunnels && level.spawns == original.spawns, "rooms and spawns round trip");
+		check(level.roomIndices == original.roomIndices, "room indices rebuilt");
+		check(std::vector<Tile::Type>(tiles, tiles + original.tiles.size()) == original.tiles, "tiles round trip");
+	}
+
+	// Each copy breaks one thing
+	{
+		Level level = original;
+		level.tiles[level.tiles.size() / 2u] = Tile::TypeCount;
+		check(!loads(level), "unknown tile type rejected");
+	}
+	{
+		Level level = original;
+		level.spawns.clear();
+		check(!loads(level), "level without spawns rejected");
+	}
+	{
+		Level level = original;
+		level.spawns.push_back(sf::Vector2u(level.size.x, 0u));
+		check(!loads(level), "spawn off the map rejected");
+	}
+	{
+		Level level = original;
+		level.rooms.push_back(sf::IntRect(level.size.x - 2, 1, 4, 4));
+		check(!loads(level), "room past the map rejected");
+	}
+	{
+		Level level = original;
+		level.tunnels.push_back(sf::IntRect(-1, 1, 4, 1));
+		check(!loads(level), "tunnel with negative origin rejected");
+	}
+	{
+		Level level = original;
+		level.rooms.push_back(sf::IntRect(1, 1, -3, 4));
+		check(!loads(level), "room with negative size rejected");
+	}
+	{
+		LevelFile::save(original, Filename);
+		std::ifstream in(Filename, std::ios::binary);
+		std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		in.close();
+		std::ofstream(Filename, std::ios::binary | std::ios::trunc).write(data.data(), data.size() - 1u);
+		check(!loads(Filename), "truncated file rejected");
+	}
+
+	std::remove(Filename.c_str());
+	if (failures == 0)
+		std::cout << "All level file checks passed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}